@@ -52,6 +52,8 @@ struct block *block_next (struct block *);
 /* Block device operations. */
 block_sector_t block_size (struct block *);
 void block_read (struct block *, block_sector_t, void *);
+void block_read_multiple (struct block *, block_sector_t, size_t cnt,
+                          void *);
 void block_write (struct block *, block_sector_t, const void *);
 const char *block_name (struct block *);
 enum block_type block_type (struct block *);
@@ -65,6 +67,11 @@ struct block_operations
   {
     void (*read) (void *aux, block_sector_t, void *buffer);
     void (*write) (void *aux, block_sector_t, const void *buffer);
+
+    /* Optional.  If null, block_read_multiple() calls `read'
+       once per sector. */
+    void (*read_multiple) (void *aux, block_sector_t, size_t cnt,
+                           void *buffer);
   };
 
 struct block *block_register (const char *name, enum block_type,
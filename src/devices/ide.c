@@ -9,6 +9,7 @@
 #include "threads/io.h"
 #include "threads/interrupt.h"
 #include "threads/synch.h"
+#include "threads/thread.h"
 
 /* The code in this file is an interface to an ATA (IDE)
    controller.  It attempts to comply to [ATA-3]. */
@@ -57,6 +58,10 @@ struct ata_disk
     struct channel *channel;    /* Channel that disk is attached to. */
     int dev_no;                 /* Device 0 or 1 for master or slave. */
     bool is_ata;                /* Is device an ATA disk? */
+
+    /* Set by identify_ata_device() for block_register(). */
+    block_sector_t capacity;    /* Size in sectors. */
+    char extra_info[128];       /* Model and serial number. */
   };
 
 /* An ATA channel (aka controller).
@@ -71,6 +76,7 @@ struct channel
     bool expecting_interrupt;   /* True if an interrupt is expected, false if
                                    any interrupt would be spurious. */
     struct semaphore completion_wait;   /* Up'd by interrupt handler. */
+    struct semaphore probed;    /* Up'd by probe_channel() when done. */
 
     struct ata_disk devices[2];     /* The devices on this channel. */
   };
@@ -79,13 +85,18 @@ struct channel
 #define CHANNEL_CNT 2
 static struct channel channels[CHANNEL_CNT];
 
+/* Number of channels whose disks ide_probe_next() has
+   registered. */
+static size_t registered_cnt;
+
 static struct block_operations ide_operations;
 
+static thread_func probe_channel;
 static void reset_channel (struct channel *);
 static bool check_device_type (struct ata_disk *);
 static void identify_ata_device (struct ata_disk *);
 
-static void select_sector (struct ata_disk *, block_sector_t);
+static void select_sector (struct ata_disk *, block_sector_t, size_t cnt);
 static void issue_pio_command (struct channel *, uint8_t command);
 static void input_sector (struct channel *, void *);
 static void output_sector (struct channel *, const void *);
@@ -97,7 +108,13 @@ static void select_device_wait (const struct ata_disk *);
 
 static void interrupt_handler (struct intr_frame *);
 
-/* Initialize the disk subsystem and detect disks. */
+/* Initialize the disk subsystem and start detecting disks.
+
+   Resetting and identifying the disks on a channel takes at
+   least 150 ms, mostly spent waiting, so each channel is probed
+   by its own kernel thread and the channels are probed at the
+   same time.  Disks are not registered with the block layer
+   until ide_probe_next() is called. */
 void
 ide_init (void) 
 {
@@ -126,6 +143,7 @@ ide_init (void)
       lock_init (&c->lock);
       c->expecting_interrupt = false;
       sema_init (&c->completion_wait, 0);
+      sema_init (&c->probed, 0);
  
       /* Initialize devices. */
       for (dev_no = 0; dev_no < 2; dev_no++)
@@ -141,24 +159,75 @@ ide_init (void)
       /* Register interrupt handler. */
       intr_register_ext (c->irq, interrupt_handler, c->name);
 
-      /* Reset hardware. */
-      reset_channel (c);
+      /* Probe the hardware in the background. */
+      if (thread_create (c->name, PRI_DEFAULT, probe_channel, c)
+          == TID_ERROR)
+        probe_channel (c);
+    }
+}
 
-      /* Distinguish ATA hard disks from other devices. */
-      if (check_device_type (&c->devices[0]))
-        check_device_type (&c->devices[1]);
+/* Waits for the next channel, in channel order, to finish being
+   probed, then registers its disks and their partitions with
+   the block layer.  Returns false if every channel's disks have
+   already been registered, true otherwise.
+
+   Registering in channel order, rather than as each probe
+   finishes, keeps the order of block devices the same from one
+   boot to the next.  Only the initial thread should call this
+   function, during boot. */
+bool
+ide_probe_next (void)
+{
+  struct channel *c;
+  int dev_no;
 
-      /* Read hard disk identity information. */
-      for (dev_no = 0; dev_no < 2; dev_no++)
-        if (c->devices[dev_no].is_ata)
-          identify_ata_device (&c->devices[dev_no]);
+  if (registered_cnt >= CHANNEL_CNT)
+    return false;
+  c = &channels[registered_cnt++];
+
+  sema_down (&c->probed);
+  for (dev_no = 0; dev_no < 2; dev_no++)
+    {
+      struct ata_disk *d = &c->devices[dev_no];
+
+      if (d->is_ata)
+        {
+          struct block *block = block_register (d->name, BLOCK_RAW,
+                                                d->extra_info, d->capacity,
+                                                &ide_operations, d);
+          partition_scan (block);
+        }
     }
+  return true;
 }
 
 /* Disk detection and identification. */
 
 static char *descramble_ata_string (char *, int size);
 
+/* Thread function that resets channel C_ and identifies the
+   disks on it. */
+static void
+probe_channel (void *c_) 
+{
+  struct channel *c = c_;
+  int dev_no;
+
+  /* Reset hardware. */
+  reset_channel (c);
+
+  /* Distinguish ATA hard disks from other devices. */
+  if (check_device_type (&c->devices[0]))
+    check_device_type (&c->devices[1]);
+
+  /* Read hard disk identity information. */
+  for (dev_no = 0; dev_no < 2; dev_no++)
+    if (c->devices[dev_no].is_ata)
+      identify_ata_device (&c->devices[dev_no]);
+
+  sema_up (&c->probed);
+}
+
 /* Resets an ATA channel and waits for any devices present on it
    to finish the reset. */
 static void
@@ -254,8 +323,7 @@ check_device_type (struct ata_disk *d)
 }
 
 /* Sends an IDENTIFY DEVICE command to disk D and reads the
-   response.  Registers the disk with the block device
-   layer. */
+   response into D's `capacity' and `extra_info' members. */
 static void
 identify_ata_device (struct ata_disk *d) 
 {
@@ -263,8 +331,6 @@ identify_ata_device (struct ata_disk *d)
   char id[BLOCK_SECTOR_SIZE];
   block_sector_t capacity;
   char *model, *serial;
-  char extra_info[128];
-  struct block *block;
 
   ASSERT (d->is_ata);
 
@@ -286,7 +352,7 @@ identify_ata_device (struct ata_disk *d)
   capacity = *(uint32_t *) &id[60 * 2];
   model = descramble_ata_string (&id[10 * 2], 20);
   serial = descramble_ata_string (&id[27 * 2], 40);
-  snprintf (extra_info, sizeof extra_info,
+  snprintf (d->extra_info, sizeof d->extra_info,
             "model \"%s\", serial \"%s\"", model, serial);
 
   /* Disable access to IDE disks over 1 GB, which are likely
@@ -302,11 +368,7 @@ identify_ata_device (struct ata_disk *d)
       d->is_ata = false;
       return;
     }
-
-  /* Register. */
-  block = block_register (d->name, BLOCK_RAW, extra_info, capacity,
-                          &ide_operations, d);
-  partition_scan (block);
+  d->capacity = capacity;
 }
 
 /* Translates STRING, which consists of SIZE bytes in a funky
@@ -347,7 +409,7 @@ ide_read (void *d_, block_sector_t sec_no, void *buffer)
   struct ata_disk *d = d_;
   struct channel *c = d->channel;
   lock_acquire (&c->lock);
-  select_sector (d, sec_no);
+  select_sector (d, sec_no, 1);
   issue_pio_command (c, CMD_READ_SECTOR_RETRY);
   sema_down (&c->completion_wait);
   if (!wait_while_busy (d))
@@ -367,7 +429,7 @@ ide_write (void *d_, block_sector_t sec_no, const void *buffer)
   struct ata_disk *d = d_;
   struct channel *c = d->channel;
   lock_acquire (&c->lock);
-  select_sector (d, sec_no);
+  select_sector (d, sec_no, 1);
   issue_pio_command (c, CMD_WRITE_SECTOR_RETRY);
   if (!wait_while_busy (d))
     PANIC ("%s: disk write failed, sector=%"PRDSNu, d->name, sec_no);
@@ -376,24 +438,68 @@ ide_write (void *d_, block_sector_t sec_no, const void *buffer)
   lock_release (&c->lock);
 }
 
+/* Largest number of sectors read by one READ SECTOR command.
+   The hardware allows 256, but a count of 256 is written as 0. */
+#define READ_MULTIPLE_MAX 255
+
+/* Reads the CNT sectors starting at SEC_NO from disk D into
+   BUFFER, which must have room for CNT * BLOCK_SECTOR_SIZE
+   bytes.  Transfers up to READ_MULTIPLE_MAX sectors per command;
+   the disk interrupts once for each sector.
+   Internally synchronizes accesses to disks, so external
+   per-disk locking is unneeded. */
+static void
+ide_read_multiple (void *d_, block_sector_t sec_no, size_t cnt,
+                   void *buffer_)
+{
+  struct ata_disk *d = d_;
+  struct channel *c = d->channel;
+  uint8_t *buffer = buffer_;
+
+  lock_acquire (&c->lock);
+  while (cnt > 0)
+    {
+      size_t run = cnt < READ_MULTIPLE_MAX ? cnt : READ_MULTIPLE_MAX;
+      size_t i;
+
+      select_sector (d, sec_no, run);
+      issue_pio_command (c, CMD_READ_SECTOR_RETRY);
+      for (i = 0; i < run; i++)
+        {
+          sema_down (&c->completion_wait);
+          if (!wait_while_busy (d))
+            PANIC ("%s: disk read failed, sector=%"PRDSNu,
+                   d->name, sec_no + i);
+          input_sector (c, buffer);
+          buffer += BLOCK_SECTOR_SIZE;
+        }
+      sec_no += run;
+      cnt -= run;
+    }
+  lock_release (&c->lock);
+}
+
 static struct block_operations ide_operations =
   {
     ide_read,
-    ide_write
+    ide_write,
+    ide_read_multiple
   };
 
 /* Selects device D, waiting for it to become ready, and then
-   writes SEC_NO to the disk's sector selection registers.  (We
-   use LBA mode.) */
+   writes SEC_NO to the disk's sector selection registers and CNT,
+   from 1 to 255, to its sector count register.  (We use LBA
+   mode.) */
 static void
-select_sector (struct ata_disk *d, block_sector_t sec_no)
+select_sector (struct ata_disk *d, block_sector_t sec_no, size_t cnt)
 {
   struct channel *c = d->channel;
 
   ASSERT (sec_no < (1UL << 28));
+  ASSERT (cnt >= 1 && cnt <= 255);
   
   select_device_wait (d);
-  outb (reg_nsect (c), 1);
+  outb (reg_nsect (c), cnt);
   outb (reg_lbal (c), sec_no);
   outb (reg_lbam (c), sec_no >> 8);
   outb (reg_lbah (c), (sec_no >> 16));
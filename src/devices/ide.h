@@ -1,6 +1,9 @@
 #ifndef DEVICES_IDE_H
 #define DEVICES_IDE_H
 
+#include <stdbool.h>
+
 void ide_init (void);
+bool ide_probe_next (void);
 
 #endif /* devices/ide.h */
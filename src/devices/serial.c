@@ -1,12 +1,15 @@
 #include "devices/serial.h"
 #include <debug.h>
+#include <stdio.h>
+#include <string.h>
 #include "devices/input.h"
-#include "devices/intq.h"
 #include "devices/timer.h"
 #include "threads/io.h"
 #include "threads/interrupt.h"
+#include "threads/palloc.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
+#include "threads/vaddr.h"
 
 /* Register definitions for the 16550A UART used in PCs.
    The 16550A has a lot more going on than shown here, but this
@@ -37,6 +40,14 @@
 #define IER_RECV 0x01           /* Interrupt when data received. */
 #define IER_XMIT 0x02           /* Interrupt when transmit finishes. */
 
+/* FIFO Control Register bits. */
+#define FCR_ENABLE 0x01         /* Enable FIFOs. */
+#define FCR_CLEAR_RECV 0x02     /* Clear receive FIFO. */
+#define FCR_CLEAR_XMIT 0x04     /* Clear transmit FIFO. */
+
+/* Interrupt Identification Register bits. */
+#define IIR_FIFO 0xc0           /* Both set if FIFOs are enabled. */
+
 /* Line Control Register bits. */
 #define LCR_N81 0x03            /* No parity, 8 data bits, 1 stop bit. */
 #define LCR_DLAB 0x80           /* Divisor Latch Access Bit (DLAB). */
@@ -48,14 +59,38 @@
 #define LSR_DR 0x01             /* Data Ready: received data byte is in RBR. */
 #define LSR_THRE 0x20           /* THR Empty. */
 
+/* Depth of the 16550A's transmit FIFO. */
+#define FIFO_DEPTH 16
+
 /* Transmission mode. */
 static enum { UNINIT, POLL, QUEUE } mode;
 
-/* Data to be transmitted. */
-static struct intq txq;
+/* Data to be transmitted, in a ring of TXQ_SIZE bytes allocated
+   when queued mode starts.  TXQ_HEAD and TXQ_TAIL run freely and
+   are reduced modulo TXQ_SIZE only to index the ring, so the
+   number of queued bytes is always TXQ_TAIL - TXQ_HEAD. */
+#define TXQ_SIZE PGSIZE
+static uint8_t *txq;
+static size_t txq_head, txq_tail;
+
+/* Bytes the transmitter accepts at once when it is empty: the
+   FIFO depth, or 1 if the UART has no working FIFO. */
+static size_t xmit_depth = 1;
+
+/* Threads sleeping until the transmit ring has room, and the
+   number of them. */
+static struct semaphore txq_room;
+static unsigned txq_waiter_cnt;
+
+/* Statistics. */
+static long long tx_byte_cnt;   /* # of bytes queued for output. */
+static long long tx_stall_cnt;  /* # of times a writer slept on a full ring. */
+static long long tx_poll_cnt;   /* # of bytes polled out of a full ring. */
+static size_t tx_peak;          /* Most bytes ever queued at once. */
 
 static void set_serial (int bps);
 static void putc_poll (uint8_t);
+static size_t xmit_fill (void);
 static void write_ier (void);
 static intr_handler_func serial_interrupt;
 
@@ -71,13 +106,14 @@ init_poll (void)
   outb (FCR_REG, 0);                    /* Disable FIFO. */
   set_serial (9600);                    /* 9.6 kbps, N-8-1. */
   outb (MCR_REG, MCR_OUT2);             /* Required to enable interrupts. */
-  intq_init (&txq);
   mode = POLL;
 } 
 
 /* Initializes the serial port device for queued interrupt-driven
    I/O.  With interrupt-driven I/O we don't waste CPU time
-   waiting for the serial device to become ready. */
+   waiting for the serial device to become ready.  Output goes
+   through a page-sized ring and out the 16550A's FIFO; if the
+   ring cannot be allocated we stay in polling mode. */
 void
 serial_init_queue (void) 
 {
@@ -87,6 +123,18 @@ serial_init_queue (void)
     init_poll ();
   ASSERT (mode == POLL);
 
+  txq = palloc_get_page (0);
+  if (txq == NULL)
+    return;
+  sema_init (&txq_room, 0);
+
+  /* Enable the FIFOs, with receive interrupts at every byte, and
+     check that they are really there: the original 16550 and
+     earlier UARTs have none that work. */
+  outb (FCR_REG, FCR_ENABLE | FCR_CLEAR_RECV | FCR_CLEAR_XMIT);
+  if ((inb (IIR_REG) & IIR_FIFO) == IIR_FIFO)
+    xmit_depth = FIFO_DEPTH;
+
   intr_register_ext (0x20 + 4, serial_interrupt, "serial");
   mode = QUEUE;
   old_level = intr_disable ();
@@ -98,34 +146,77 @@ serial_init_queue (void)
 void
 serial_putc (uint8_t byte) 
 {
+  serial_write (&byte, 1);
+}
+
+/* Sends the N bytes in BUFFER to the serial port.
+
+   In queued mode the bytes are copied into the transmit ring in
+   as few pieces as possible, with interrupts disabled only once
+   for the whole buffer.  If the ring fills up, a thread that
+   may sleep waits for the interrupt handler to drain half of
+   it, however many other writers are already waiting; otherwise
+   (in an interrupt handler, or with interrupts off) we make
+   room by polling the bytes out ourselves. */
+void
+serial_write (const void *buffer, size_t n)
+{
+  const uint8_t *p = buffer;
   enum intr_level old_level = intr_disable ();
 
   if (mode != QUEUE)
     {
       /* If we're not set up for interrupt-driven I/O yet,
-         use dumb polling to transmit a byte. */
+         use dumb polling to transmit. */
       if (mode == UNINIT)
         init_poll ();
-      putc_poll (byte); 
+      while (n-- > 0)
+        putc_poll (*p++);
     }
-  else 
+  else
     {
-      /* Otherwise, queue a byte and update the interrupt enable
-         register. */
-      if (old_level == INTR_OFF && intq_full (&txq)) 
+      while (n > 0)
         {
-          /* Interrupts are off and the transmit queue is full.
-             If we wanted to wait for the queue to empty,
-             we'd have to reenable interrupts.
-             That's impolite, so we'll send a character via
-             polling instead. */
-          putc_poll (intq_getc (&txq)); 
+          size_t used = txq_tail - txq_head;
+          size_t ofs = txq_tail % TXQ_SIZE;
+          size_t chunk;
+
+          if (used == TXQ_SIZE)
+            {
+              if (old_level == INTR_ON && !intr_context ())
+                {
+                  tx_stall_cnt++;
+                  txq_waiter_cnt++;
+                  write_ier ();
+                  sema_down (&txq_room);
+                }
+              else
+                {
+                  while ((inb (LSR_REG) & LSR_THRE) == 0)
+                    continue;
+                  tx_poll_cnt += xmit_fill ();
+                }
+              continue;
+            }
+
+          /* Copy as much as fits before the ring wraps. */
+          chunk = TXQ_SIZE - used;
+          if (chunk > TXQ_SIZE - ofs)
+            chunk = TXQ_SIZE - ofs;
+          if (chunk > n)
+            chunk = n;
+          memcpy (txq + ofs, p, chunk);
+          txq_tail += chunk;
+          p += chunk;
+          n -= chunk;
+
+          tx_byte_cnt += chunk;
+          if (used + chunk > tx_peak)
+            tx_peak = used + chunk;
         }
-
-      intq_putc (&txq, byte); 
       write_ier ();
     }
-  
+
   intr_set_level (old_level);
 }
 
@@ -135,11 +226,24 @@ void
 serial_flush (void) 
 {
   enum intr_level old_level = intr_disable ();
-  while (!intq_empty (&txq))
-    putc_poll (intq_getc (&txq));
+  while (txq_head != txq_tail)
+    {
+      while ((inb (LSR_REG) & LSR_THRE) == 0)
+        continue;
+      xmit_fill ();
+    }
   intr_set_level (old_level);
 }
 
+/* Prints serial port statistics. */
+void
+serial_print_stats (void) 
+{
+  printf ("Serial: %lld bytes queued, %zu peak, %lld stalls, "
+          "%lld bytes polled\n",
+          tx_byte_cnt, tx_peak, tx_stall_cnt, tx_poll_cnt);
+}
+
 /* The fullness of the input buffer may have changed.  Reassess
    whether we should block receive interrupts.
    Called by the input buffer routines when characters are added
@@ -182,7 +286,7 @@ write_ier (void)
 
   /* Enable transmit interrupt if we have any characters to
      transmit. */
-  if (!intq_empty (&txq))
+  if (txq_head != txq_tail)
     ier |= IER_XMIT;
 
   /* Enable receive interrupt if we have room to store any
@@ -205,6 +309,20 @@ putc_poll (uint8_t byte)
   outb (THR_REG, byte);
 }
 
+/* Moves as many queued bytes into the transmitter as it can
+   take, which must be empty, and returns the number moved. */
+static size_t
+xmit_fill (void) 
+{
+  size_t cnt;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  for (cnt = 0; cnt < xmit_depth && txq_head != txq_tail; cnt++)
+    outb (THR_REG, txq[txq_head++ % TXQ_SIZE]);
+  return cnt;
+}
+
 /* Serial interrupt handler. */
 static void
 serial_interrupt (struct intr_frame *f UNUSED) 
@@ -218,10 +336,17 @@ serial_interrupt (struct intr_frame *f UNUSED)
   while (!input_full () && (inb (LSR_REG) & LSR_DR) != 0)
     input_putc (inb (RBR_REG));
 
-  /* As long as we have a byte to transmit, and the hardware is
-     ready to accept a byte for transmission, transmit a byte. */
-  while (!intq_empty (&txq) && (inb (LSR_REG) & LSR_THRE) != 0) 
-    outb (THR_REG, intq_getc (&txq));
+  /* If the transmitter is empty, fill it from the ring: a whole
+     FIFO's worth of bytes per interrupt, not just one. */
+  if (txq_head != txq_tail && (inb (LSR_REG) & LSR_THRE) != 0) 
+    xmit_fill ();
+
+  /* Wake the writers waiting for room once the ring is half
+     empty, so that they refill the ring in large pieces.  Each
+     rechecks for room when it runs. */
+  if (txq_tail - txq_head <= TXQ_SIZE / 2)
+    for (; txq_waiter_cnt > 0; txq_waiter_cnt--)
+      sema_up (&txq_room);
 
   /* Update interrupt enable register based on queue status. */
   write_ier ();
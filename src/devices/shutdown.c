@@ -1,13 +1,17 @@
 #include "devices/shutdown.h"
 #include <console.h>
 #include <stdio.h>
+#include <trace.h>
 #include "devices/kbd.h"
 #include "devices/serial.h"
 #include "devices/timer.h"
 #include "threads/io.h"
+#include "threads/palloc.h"
+#include "threads/profile.h"
 #include "threads/thread.h"
 #ifdef USERPROG
 #include "userprog/exception.h"
+#include "userprog/process.h"
 #endif
 #ifdef FILESYS
 #include "devices/block.h"
@@ -93,8 +97,10 @@ shutdown_power_off (void)
 #ifdef FILESYS
   filesys_done ();
 #endif
+  trace_dump ();
 
   print_stats ();
+  profile_print ();
 
   printf ("Powering off...\n");
   serial_flush ();
@@ -127,12 +133,16 @@ print_stats (void)
 {
   timer_print_stats ();
   thread_print_stats ();
+  palloc_print_stats ();
 #ifdef FILESYS
   block_print_stats ();
 #endif
   console_print_stats ();
+  serial_print_stats ();
   kbd_print_stats ();
+  trace_print_stats ();
 #ifdef USERPROG
   exception_print_stats ();
+  process_print_stats ();
 #endif
 }
@@ -1,10 +1,14 @@
 #include "devices/timer.h"
+#include <ctype.h>
 #include <debug.h>
+#include <heap.h>
 #include <inttypes.h>
+#include <limits.h>
 #include <round.h>
 #include <stdio.h>
 #include "devices/pit.h"
 #include "threads/interrupt.h"
+#include "threads/profile.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
   
@@ -24,7 +28,13 @@ static int64_t ticks;
    Initialized by timer_calibrate(). */
 static unsigned loops_per_tick;
 
+/* Threads blocked in timer_sleep(), soonest wakeup first.
+   Threads waking on the same tick come out in the order they
+   went to sleep. */
+static struct heap sleepers;
+
 static intr_handler_func timer_interrupt;
+static heap_less_func wakes_sooner;
 static bool too_many_loops (unsigned loops);
 static void busy_wait (int64_t loops);
 static void real_time_sleep (int64_t num, int32_t denom);
@@ -36,16 +46,54 @@ void
 timer_init (void) 
 {
   pit_configure_channel (0, 2, TIMER_FREQ);
+  heap_init (&sleepers, wakes_sooner, NULL);
   intr_register_ext (0x20, timer_interrupt, "8254 Timer");
 }
 
-/* Calibrates loops_per_tick, used to implement brief delays. */
+/* Sets loops_per_tick from RATE, a rate in loops per second
+   printed by timer_calibrate() on an earlier boot of the same
+   machine, so that timer_calibrate() need not measure it again.
+   RATE may contain the commas that timer_calibrate() prints.
+   Called while parsing the kernel command line. */
+void
+timer_set_calibration (const char *rate) 
+{
+  uint64_t loops_per_sec = 0;
+  const char *p;
+
+  if (rate == NULL || *rate == '\0')
+    PANIC ("-calibrate requires a rate");
+  for (p = rate; *p != '\0'; p++)
+    if (isdigit ((unsigned char) *p))
+      {
+        /* Stopping as soon as the rate is too big also keeps
+           LOOPS_PER_SEC far from overflowing. */
+        loops_per_sec = loops_per_sec * 10 + (*p - '0');
+        if (loops_per_sec / TIMER_FREQ > UINT_MAX)
+          PANIC ("timer calibration `%s' out of range", rate);
+      }
+    else if (*p != ',')
+      PANIC ("bad timer calibration `%s'", rate);
+  if (loops_per_sec / TIMER_FREQ == 0)
+    PANIC ("timer calibration `%s' out of range", rate);
+
+  loops_per_tick = loops_per_sec / TIMER_FREQ;
+}
+
+/* Calibrates loops_per_tick, used to implement brief delays,
+   unless timer_set_calibration() already set it. */
 void
 timer_calibrate (void) 
 {
   unsigned high_bit, test_bit;
 
   ASSERT (intr_get_level () == INTR_ON);
+  if (loops_per_tick != 0)
+    {
+      printf ("Timer calibration: %'"PRIu64" loops/s (given).\n",
+              (uint64_t) loops_per_tick * TIMER_FREQ);
+      return;
+    }
   printf ("Calibrating timer...  ");
 
   /* Approximate loops_per_tick as the largest power-of-two
@@ -85,15 +133,27 @@ timer_elapsed (int64_t then)
 }
 
 /* Sleeps for approximately TICKS timer ticks.  Interrupts must
-   be turned on. */
+   be turned on.
+
+   The thread blocks until the timer interrupt wakes it, rather
+   than yielding in a loop: the ready queue always runs the
+   highest priority thread first, so a sleeper that kept yielding
+   would starve every lower priority thread until it woke. */
 void
 timer_sleep (int64_t ticks) 
 {
-  int64_t start = timer_ticks ();
+  struct thread *t = thread_current ();
+  enum intr_level old_level;
 
   ASSERT (intr_get_level () == INTR_ON);
-  while (timer_elapsed (start) < ticks) 
-    thread_yield ();
+  if (ticks <= 0)
+    return;
+
+  old_level = intr_disable ();
+  t->wakeup_tick = timer_ticks () + ticks;
+  heap_insert (&sleepers, &t->elem);
+  thread_block ();
+  intr_set_level (old_level);
 }
 
 /* Sleeps for approximately MS milliseconds.  Interrupts must be
@@ -168,10 +228,36 @@ timer_print_stats (void)
 
 /* Timer interrupt handler. */
 static void
-timer_interrupt (struct intr_frame *args UNUSED)
+timer_interrupt (struct intr_frame *args)
 {
   ticks++;
+
+  /* Wake the threads whose sleep is over. */
+  while (!heap_empty (&sleepers))
+    {
+      struct thread *t = heap_entry (heap_top (&sleepers),
+                                     struct thread, elem);
+      if (t->wakeup_tick > ticks)
+        break;
+      heap_pop (&sleepers);
+      thread_unblock (t);
+    }
+
   thread_tick ();
+  if (profile_enabled)
+    profile_sample (args);
+}
+
+/* Returns true if sleeping thread A wakes before sleeping thread
+   B, given the `elem' members of each.  Orders `sleepers'. */
+static bool
+wakes_sooner (const struct heap_elem *a_, const struct heap_elem *b_,
+              void *aux UNUSED)
+{
+  const struct thread *a = heap_entry (a_, struct thread, elem);
+  const struct thread *b = heap_entry (b_, struct thread, elem);
+
+  return a->wakeup_tick < b->wakeup_tick;
 }
 
 /* Returns true if LOOPS iterations waits for more than one timer
@@ -8,6 +8,7 @@
 #define TIMER_FREQ 100
 
 void timer_init (void);
+void timer_set_calibration (const char *rate);
 void timer_calibrate (void);
 
 int64_t timer_ticks (void);
@@ -0,0 +1,123 @@
+/* rcp.c
+
+   Copies one file to another, using the system call ring to
+   batch the reads and the writes. */
+
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+
+/* Bytes copied per request, and requests per batch. */
+#define CHUNK 512
+#define BATCH 16
+
+/* Page-aligned address at which to map the ring. */
+static struct sq_ring *const ring = (struct sq_ring *) 0x10000000;
+
+static char buffers[BATCH][CHUNK];
+
+/* Queues a request to ring. */
+static void
+submit (enum ring_op op, int fd, void *buf, unsigned len, unsigned ofs)
+{
+  struct sq_entry *sqe = &ring->sqes[ring->sq_tail % RING_ENTRIES];
+  sqe->opcode = op;
+  sqe->fd = fd;
+  sqe->addr = (uint32_t) buf;
+  sqe->len = len;
+  sqe->offset = ofs;
+  sqe->user_data = len;
+  ring->sq_tail++;
+}
+
+/* Submits the CNT queued requests with one system call and
+   reaps their completions.  Returns true if every request
+   transferred as many bytes as it asked for. */
+static bool
+run_batch (int cnt)
+{
+  bool ok = ring_enter (cnt) == cnt;
+  while (ring->cq_head != ring->cq_tail)
+    {
+      struct cq_entry *cqe = &ring->cqes[ring->cq_head % RING_ENTRIES];
+      if (cqe->res != (int32_t) cqe->user_data)
+        ok = false;
+      ring->cq_head++;
+    }
+  return ok;
+}
+
+int
+main (int argc, char *argv[]) 
+{
+  int in_fd, out_fd;
+  int size, ofs;
+
+  if (argc != 3) 
+    {
+      printf ("usage: rcp OLD NEW\n");
+      return EXIT_FAILURE;
+    }
+
+  if (!ring_setup (ring))
+    {
+      printf ("ring_setup failed\n");
+      return EXIT_FAILURE;
+    }
+
+  /* Open input file. */
+  in_fd = open (argv[1]);
+  if (in_fd < 0) 
+    {
+      printf ("%s: open failed\n", argv[1]);
+      return EXIT_FAILURE;
+    }
+  size = filesize (in_fd);
+
+  /* Create and open output file. */
+  if (!create (argv[2], size)) 
+    {
+      printf ("%s: create failed\n", argv[2]);
+      return EXIT_FAILURE;
+    }
+  out_fd = open (argv[2]);
+  if (out_fd < 0) 
+    {
+      printf ("%s: open failed\n", argv[2]);
+      return EXIT_FAILURE;
+    }
+
+  /* Copy data, BATCH chunks at a time: one system call reads
+     them all, another writes them all. */
+  for (ofs = 0; ofs < size; ofs += BATCH * CHUNK)
+    {
+      int cnt = 0;
+      int i;
+
+      for (i = 0; i < BATCH && ofs + i * CHUNK < size; i++, cnt++)
+        {
+          int len = size - (ofs + i * CHUNK);
+          submit (RING_OP_PREAD, in_fd, buffers[i],
+                  len < CHUNK ? len : CHUNK, ofs + i * CHUNK);
+        }
+      if (!run_batch (cnt))
+        {
+          printf ("%s: read failed\n", argv[1]);
+          return EXIT_FAILURE;
+        }
+
+      for (i = 0; i < cnt; i++)
+        {
+          int len = size - (ofs + i * CHUNK);
+          submit (RING_OP_PWRITE, out_fd, buffers[i],
+                  len < CHUNK ? len : CHUNK, ofs + i * CHUNK);
+        }
+      if (!run_batch (cnt))
+        {
+          printf ("%s: write failed\n", argv[2]);
+          return EXIT_FAILURE;
+        }
+    }
+
+  return EXIT_SUCCESS;
+}
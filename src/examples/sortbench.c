@@ -0,0 +1,209 @@
+/* sortbench.c
+
+   Compares qsort() from lib/stdlib.c against the heapsort with
+   byte-by-byte swaps that it replaced, on arrays of ints, of
+   word-sized records, and of odd-sized records, each in random,
+   ascending, descending, and few-distinct-values order.  Prints
+   the comparisons and processor cycles each takes and checks
+   that both results are sorted. */
+
+#include <random.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syscall.h>
+
+/* Number of elements in each array sorted. */
+#define SORT_CNT 8192
+
+/* Largest element size benchmarked. */
+#define MAX_ELEM_SIZE 12
+
+/* Element sizes: an int, three words, and an odd size that
+   can't be swapped a word at a time. */
+static const size_t elem_sizes[] = {sizeof (int), 12, 5};
+
+/* Input orders. */
+enum order
+  {
+    RANDOM,                     /* Random. */
+    ASCENDING,                  /* Already sorted. */
+    DESCENDING,                 /* Sorted in reverse. */
+    FEW_VALUES,                 /* Only a few distinct values. */
+    ORDER_CNT
+  };
+static const char *order_names[ORDER_CNT] =
+  {"random", "ascending", "descending", "few values"};
+
+/* Input, and the copy being sorted.  Static to reduce stack
+   usage. */
+static unsigned char input[SORT_CNT * MAX_ELEM_SIZE];
+static unsigned char array[SORT_CNT * MAX_ELEM_SIZE];
+
+/* Size of the elements being compared, and number of
+   comparisons made so far. */
+static size_t elem_size;
+static unsigned long compare_cnt;
+
+/* Compares the ELEM_SIZE-byte elements at A and B as big-endian
+   numbers, counting the comparison. */
+static int
+compare_elems (const void *a, const void *b)
+{
+  compare_cnt++;
+  return memcmp (a, b, elem_size);
+}
+
+/* The heapsort that qsort() used to be, from lib/stdlib.c. */
+
+/* Swaps elements with 1-based indexes A_IDX and B_IDX in ARRAY
+   with elements of SIZE bytes each. */
+static void
+old_swap (unsigned char *array, size_t a_idx, size_t b_idx, size_t size)
+{
+  unsigned char *a = array + (a_idx - 1) * size;
+  unsigned char *b = array + (b_idx - 1) * size;
+  size_t i;
+
+  for (i = 0; i < size; i++)
+    {
+      unsigned char t = a[i];
+      a[i] = b[i];
+      b[i] = t;
+    }
+}
+
+/* Compares elements with 1-based indexes A_IDX and B_IDX in
+   ARRAY with elements of SIZE bytes each. */
+static int
+old_compare (unsigned char *array, size_t a_idx, size_t b_idx, size_t size,
+             int (*compare) (const void *, const void *))
+{
+  return compare (array + (a_idx - 1) * size, array + (b_idx - 1) * size);
+}
+
+/* "Float down" the element with 1-based index I in ARRAY of CNT
+   elements of SIZE bytes each. */
+static void
+old_heapify (unsigned char *array, size_t i, size_t cnt, size_t size,
+             int (*compare) (const void *, const void *))
+{
+  for (;;)
+    {
+      size_t left = 2 * i;
+      size_t right = 2 * i + 1;
+      size_t max = i;
+      if (left <= cnt && old_compare (array, left, max, size, compare) > 0)
+        max = left;
+      if (right <= cnt && old_compare (array, right, max, size, compare) > 0)
+        max = right;
+      if (max == i)
+        break;
+      old_swap (array, i, max, size);
+      i = max;
+    }
+}
+
+/* Sorts ARRAY, which contains CNT elements of SIZE bytes each,
+   using COMPARE. */
+static void
+old_qsort (void *array, size_t cnt, size_t size,
+           int (*compare) (const void *, const void *))
+{
+  size_t i;
+
+  for (i = cnt / 2; i > 0; i--)
+    old_heapify (array, i, cnt, size, compare);
+  for (i = cnt; i > 1; i--)
+    {
+      old_swap (array, 1, i, size);
+      old_heapify (array, 1, i - 1, size, compare);
+    }
+}
+
+/* Reads the processor's time stamp counter. */
+static inline uint64_t
+read_tsc (void)
+{
+  uint64_t tsc;
+  asm volatile ("rdtsc" : "=A" (tsc));
+  return tsc;
+}
+
+/* Fills INPUT with SORT_CNT elements of ELEM_SIZE bytes in the
+   given ORDER. */
+static void
+make_input (enum order order)
+{
+  size_t i;
+
+  random_bytes (input, SORT_CNT * elem_size);
+  if (order == RANDOM)
+    return;
+
+  /* Store a key in the leading bytes, which decide the order,
+     leaving the rest of each element random. */
+  for (i = 0; i < SORT_CNT; i++)
+    {
+      unsigned char *e = input + i * elem_size;
+      unsigned key = (order == ASCENDING ? i
+                      : order == DESCENDING ? SORT_CNT - i
+                      : e[0] % 4);
+
+      e[0] = key >> 8;
+      e[1] = key;
+    }
+}
+
+/* Sorts a copy of INPUT with SORT, then prints NAME, the
+   comparisons and cycles taken, and whether the result is
+   sorted.  Returns true if it is. */
+static bool
+run (const char *name,
+     void (*sort) (void *, size_t, size_t,
+                   int (*) (const void *, const void *)))
+{
+  uint64_t cycles;
+  bool sorted = true;
+  size_t i;
+
+  memcpy (array, input, SORT_CNT * elem_size);
+  compare_cnt = 0;
+  cycles = read_tsc ();
+  sort (array, SORT_CNT, elem_size, compare_elems);
+  cycles = read_tsc () - cycles;
+
+  for (i = 1; i < SORT_CNT; i++)
+    if (memcmp (array + (i - 1) * elem_size, array + i * elem_size,
+                elem_size) > 0)
+      sorted = false;
+
+  printf ("  %-8s %8lu compares %12llu cycles%s\n",
+          name, compare_cnt, cycles, sorted ? "" : "  NOT SORTED");
+  return sorted;
+}
+
+int
+main (void)
+{
+  bool ok = true;
+  size_t i;
+
+  for (i = 0; i < sizeof elem_sizes / sizeof *elem_sizes; i++)
+    {
+      enum order order;
+
+      elem_size = elem_sizes[i];
+      for (order = 0; order < ORDER_CNT; order++)
+        {
+          printf ("%d %zu-byte elements, %s:\n",
+                  SORT_CNT, elem_size, order_names[order]);
+          make_input (order);
+          ok = run ("heapsort", old_qsort) && ok;
+          ok = run ("qsort", qsort) && ok;
+        }
+    }
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
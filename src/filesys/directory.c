@@ -5,6 +5,7 @@
 #include "filesys/filesys.h"
 #include "filesys/inode.h"
 #include "threads/malloc.h"
+#include "threads/synch.h"
 
 /* A directory. */
 struct dir 
@@ -119,15 +120,19 @@ bool
 dir_lookup (const struct dir *dir, const char *name,
             struct inode **inode) 
 {
+  struct rwlock *dir_lock;
   struct dir_entry e;
 
   ASSERT (dir != NULL);
   ASSERT (name != NULL);
 
+  dir_lock = inode_get_dir_lock (dir->inode);
+  rwlock_acquire_read (dir_lock);
   if (lookup (dir, name, &e, NULL))
     *inode = inode_open (e.inode_sector);
   else
     *inode = NULL;
+  rwlock_release_read (dir_lock);
 
   return *inode != NULL;
 }
@@ -152,6 +157,8 @@ dir_add (struct dir *dir, const char *name, block_sector_t inode_sector)
   if (*name == '\0' || strlen (name) > NAME_MAX)
     return false;
 
+  rwlock_acquire_write (inode_get_dir_lock (dir->inode));
+
   /* Check that NAME is not in use. */
   if (lookup (dir, name, NULL, NULL))
     goto done;
@@ -175,6 +182,7 @@ dir_add (struct dir *dir, const char *name, block_sector_t inode_sector)
   success = inode_write_at (dir->inode, &e, sizeof e, ofs) == sizeof e;
 
  done:
+  rwlock_release_write (inode_get_dir_lock (dir->inode));
   return success;
 }
 
@@ -192,6 +200,8 @@ dir_remove (struct dir *dir, const char *name)
   ASSERT (dir != NULL);
   ASSERT (name != NULL);
 
+  rwlock_acquire_write (inode_get_dir_lock (dir->inode));
+
   /* Find directory entry. */
   if (!lookup (dir, name, &e, &ofs))
     goto done;
@@ -211,6 +221,7 @@ dir_remove (struct dir *dir, const char *name)
   success = true;
 
  done:
+  rwlock_release_write (inode_get_dir_lock (dir->inode));
   inode_close (inode);
   return success;
 }
@@ -221,16 +232,21 @@ dir_remove (struct dir *dir, const char *name)
 bool
 dir_readdir (struct dir *dir, char name[NAME_MAX + 1])
 {
+  struct rwlock *dir_lock = inode_get_dir_lock (dir->inode);
   struct dir_entry e;
+  bool found = false;
 
+  rwlock_acquire_read (dir_lock);
   while (inode_read_at (dir->inode, &e, sizeof e, dir->pos) == sizeof e) 
     {
       dir->pos += sizeof e;
       if (e.in_use)
         {
           strlcpy (name, e.name, NAME_MAX + 1);
-          return true;
+          found = true;
+          break;
         } 
     }
-  return false;
+  rwlock_release_read (dir_lock);
+  return found;
 }
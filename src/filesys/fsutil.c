@@ -1,5 +1,6 @@
 #include "filesys/fsutil.h"
 #include <debug.h>
+#include <round.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -67,8 +68,19 @@ fsutil_rm (char **argv)
     PANIC ("%s: delete failed\n", file_name);
 }
 
+/* Prints a line for each file extracted by fsutil_extract() if
+   true, only a summary if false.  Set by the "-v" kernel
+   option. */
+bool fsutil_verbose;
+
 /* Extracts a ustar-format tar archive from the scratch block
-   device into the Pintos file system. */
+   device into the Pintos file system.
+
+   Each file's data is read from the scratch device in runs of a
+   page's worth of sectors, using one request per run, and
+   written to the file a page at a time.  Because
+   filesys_create() allocates the whole file up front, those
+   writes go straight to the file's sectors. */
 void
 fsutil_extract (char **argv UNUSED) 
 {
@@ -76,10 +88,12 @@ fsutil_extract (char **argv UNUSED)
 
   struct block *src;
   void *header, *data;
+  size_t file_cnt = 0;
+  unsigned long long byte_cnt = 0;
 
   /* Allocate buffers. */
   header = malloc (BLOCK_SECTOR_SIZE);
-  data = malloc (BLOCK_SECTOR_SIZE);
+  data = palloc_get_page (0);
   if (header == NULL || data == NULL)
     PANIC ("couldn't allocate buffers");
 
@@ -115,7 +129,10 @@ fsutil_extract (char **argv UNUSED)
         {
           struct file *dst;
 
-          printf ("Putting '%s' into the file system...\n", file_name);
+          if (fsutil_verbose)
+            printf ("Putting '%s' into the file system...\n", file_name);
+          file_cnt++;
+          byte_cnt += size;
 
           /* Create destination file. */
           if (!filesys_create (file_name, size))
@@ -127,10 +144,13 @@ fsutil_extract (char **argv UNUSED)
           /* Do copy. */
           while (size > 0)
             {
-              int chunk_size = (size > BLOCK_SECTOR_SIZE
-                                ? BLOCK_SECTOR_SIZE
-                                : size);
-              block_read (src, sector++, data);
+              int chunk_size = size > PGSIZE ? PGSIZE : size;
+              size_t sector_cnt = DIV_ROUND_UP (chunk_size, BLOCK_SECTOR_SIZE);
+
+              if (sector + sector_cnt > block_size (src))
+                PANIC ("%s: archive truncated", file_name);
+              block_read_multiple (src, sector, sector_cnt, data);
+              sector += sector_cnt;
               if (file_write (dst, data, chunk_size) != chunk_size)
                 PANIC ("%s: write failed with %d bytes unwritten",
                        file_name, size);
@@ -142,6 +162,10 @@ fsutil_extract (char **argv UNUSED)
         }
     }
 
+  if (!fsutil_verbose)
+    printf ("Put %zu files, %llu bytes, into the file system.\n",
+            file_cnt, byte_cnt);
+
   /* Erase the ustar header from the start of the block device,
      so that the extraction operation is idempotent.  We erase
      two blocks because two blocks of zeros are the ustar
@@ -151,31 +175,77 @@ fsutil_extract (char **argv UNUSED)
   block_write (src, 0, header);
   block_write (src, 1, header);
 
-  free (data);
+  palloc_free_page (data);
   free (header);
 }
 
-/* Copies file FILE_NAME from the file system to the scratch
-   device, in ustar format.
+/* Next sector to write on the scratch device when appending.
+   The first append writes starting at the beginning of the
+   scratch device.  Later appends advance across the device.
+   This position is independent of that used for
+   fsutil_extract(), so `extract' should precede all `append's. */
+static block_sector_t append_sector;
+
+/* Opens the scratch device and writes a ustar header for a
+   regular file named NAME that is SIZE bytes long, using BUFFER
+   (one sector) as scratch space.  Returns the scratch device. */
+static struct block *
+append_begin (const char *name, off_t size, void *buffer)
+{
+  struct block *dst;
+
+  printf ("Appending '%s' to ustar archive on scratch device...\n", name);
+
+  /* Open target block device. */
+  dst = block_get_role (BLOCK_SCRATCH);
+  if (dst == NULL)
+    PANIC ("couldn't open scratch device");
 
-   The first call to this function will write starting at the
-   beginning of the scratch device.  Later calls advance across
-   the device.  This position is independent of that used for
-   fsutil_extract(), so `extract' should precede all
-   `append's. */
+  /* Write ustar header to first sector. */
+  if (!ustar_make_header (name, USTAR_REGULAR, size, buffer))
+    PANIC ("%s: name too long for ustar format", name);
+  block_write (dst, append_sector++, buffer);
+
+  return dst;
+}
+
+/* Writes the CHUNK_SIZE bytes at the start of BUFFER, which is
+   one sector long, to the next sector of DST as part of the
+   file NAME, padding with zeros. */
+static void
+append_sector_data (struct block *dst, const char *name,
+                    void *buffer, size_t chunk_size)
+{
+  if (append_sector >= block_size (dst))
+    PANIC ("%s: out of space on scratch device", name);
+  memset (buffer + chunk_size, 0, BLOCK_SECTOR_SIZE - chunk_size);
+  block_write (dst, append_sector++, buffer);
+}
+
+/* Writes the ustar end-of-archive marker, which is two
+   consecutive sectors full of zeros, to DST, using BUFFER as
+   scratch space.  Doesn't advance our position past them,
+   though, in case we have more files to append. */
+static void
+append_end (struct block *dst, void *buffer)
+{
+  memset (buffer, 0, BLOCK_SECTOR_SIZE);
+  block_write (dst, append_sector, buffer);
+  block_write (dst, append_sector + 1, buffer);
+}
+
+/* Copies file FILE_NAME from the file system to the scratch
+   device, in ustar format, following any files appended
+   earlier. */
 void
 fsutil_append (char **argv)
 {
-  static block_sector_t sector = 0;
-
   const char *file_name = argv[1];
   void *buffer;
   struct file *src;
   struct block *dst;
   off_t size;
 
-  printf ("Appending '%s' to ustar archive on scratch device...\n", file_name);
-
   /* Allocate buffer. */
   buffer = malloc (BLOCK_SECTOR_SIZE);
   if (buffer == NULL)
@@ -187,37 +257,48 @@ fsutil_append (char **argv)
     PANIC ("%s: open failed", file_name);
   size = file_length (src);
 
-  /* Open target block device. */
-  dst = block_get_role (BLOCK_SCRATCH);
-  if (dst == NULL)
-    PANIC ("couldn't open scratch device");
-  
-  /* Write ustar header to first sector. */
-  if (!ustar_make_header (file_name, USTAR_REGULAR, size, buffer))
-    PANIC ("%s: name too long for ustar format", file_name);
-  block_write (dst, sector++, buffer);
-
   /* Do copy. */
+  dst = append_begin (file_name, size, buffer);
   while (size > 0) 
     {
       int chunk_size = size > BLOCK_SECTOR_SIZE ? BLOCK_SECTOR_SIZE : size;
-      if (sector >= block_size (dst))
-        PANIC ("%s: out of space on scratch device", file_name);
       if (file_read (src, buffer, chunk_size) != chunk_size)
         PANIC ("%s: read failed with %"PROTd" bytes unread", file_name, size);
-      memset (buffer + chunk_size, 0, BLOCK_SECTOR_SIZE - chunk_size);
-      block_write (dst, sector++, buffer);
+      append_sector_data (dst, file_name, buffer, chunk_size);
       size -= chunk_size;
     }
-
-  /* Write ustar end-of-archive marker, which is two consecutive
-     sectors full of zeros.  Don't advance our position past
-     them, though, in case we have more files to append. */
-  memset (buffer, 0, BLOCK_SECTOR_SIZE);
-  block_write (dst, sector, buffer);
-  block_write (dst, sector, buffer + 1);
+  append_end (dst, buffer);
 
   /* Finish up. */
   file_close (src);
   free (buffer);
 }
+
+/* Copies the SIZE bytes at DATA to the scratch device as a file
+   named NAME, in ustar format, following any files appended
+   earlier.  Lets the kernel hand data of its own to the host
+   through the same archive as `append'. */
+void
+fsutil_append_buffer (const char *name, const void *data, size_t size)
+{
+  const uint8_t *p = data;
+  void *buffer;
+  struct block *dst;
+
+  buffer = malloc (BLOCK_SECTOR_SIZE);
+  if (buffer == NULL)
+    PANIC ("couldn't allocate buffer");
+
+  dst = append_begin (name, size, buffer);
+  while (size > 0)
+    {
+      size_t chunk_size = size > BLOCK_SECTOR_SIZE ? BLOCK_SECTOR_SIZE : size;
+      memcpy (buffer, p, chunk_size);
+      append_sector_data (dst, name, buffer, chunk_size);
+      p += chunk_size;
+      size -= chunk_size;
+    }
+  append_end (dst, buffer);
+
+  free (buffer);
+}
@@ -1,10 +1,16 @@
 #ifndef FILESYS_FSUTIL_H
 #define FILESYS_FSUTIL_H
 
+#include <stdbool.h>
+#include <stddef.h>
+
+extern bool fsutil_verbose;
+
 void fsutil_ls (char **argv);
 void fsutil_cat (char **argv);
 void fsutil_rm (char **argv);
 void fsutil_extract (char **argv);
 void fsutil_append (char **argv);
+void fsutil_append_buffer (const char *name, const void *data, size_t size);
 
 #endif /* filesys/fsutil.h */
@@ -1,6 +1,7 @@
 #include <console.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 #include "devices/serial.h"
 #include "devices/vga.h"
 #include "threads/init.h"
@@ -9,6 +10,16 @@
 
 static void vprintf_helper (char, void *);
 static void putchar_have_lock (uint8_t c);
+static void putbuf_have_lock (const char *buffer, size_t n);
+
+/* Output of a vprintf() call, collected so that it reaches the
+   serial port in pieces rather than a character at a time. */
+struct vprintf_aux
+  {
+    char buf[64];               /* Characters not yet written. */
+    size_t len;                 /* Number of characters in BUF. */
+    int char_cnt;               /* Total characters output. */
+  };
 
 /* The console lock.
    Both the vga and serial layers do their own locking, so it's
@@ -125,13 +136,17 @@ console_locked_by_current_thread (void)
 int
 vprintf (const char *format, va_list args) 
 {
-  int char_cnt = 0;
+  struct vprintf_aux aux;
+
+  aux.len = 0;
+  aux.char_cnt = 0;
 
   acquire_console ();
-  __vprintf (format, args, vprintf_helper, &char_cnt);
+  __vprintf (format, args, vprintf_helper, &aux);
+  putbuf_have_lock (aux.buf, aux.len);
   release_console ();
 
-  return char_cnt;
+  return aux.char_cnt;
 }
 
 /* Writes string S to the console, followed by a new-line
@@ -140,8 +155,7 @@ int
 puts (const char *s) 
 {
   acquire_console ();
-  while (*s != '\0')
-    putchar_have_lock (*s++);
+  putbuf_have_lock (s, strlen (s));
   putchar_have_lock ('\n');
   release_console ();
 
@@ -153,8 +167,7 @@ void
 putbuf (const char *buffer, size_t n) 
 {
   acquire_console ();
-  while (n-- > 0)
-    putchar_have_lock (*buffer++);
+  putbuf_have_lock (buffer, n);
   release_console ();
 }
 
@@ -171,11 +184,17 @@ putchar (int c)
 
 /* Helper function for vprintf(). */
 static void
-vprintf_helper (char c, void *char_cnt_) 
+vprintf_helper (char c, void *aux_) 
 {
-  int *char_cnt = char_cnt_;
-  (*char_cnt)++;
-  putchar_have_lock (c);
+  struct vprintf_aux *aux = aux_;
+
+  aux->char_cnt++;
+  aux->buf[aux->len++] = c;
+  if (aux->len >= sizeof aux->buf)
+    {
+      putbuf_have_lock (aux->buf, aux->len);
+      aux->len = 0;
+    }
 }
 
 /* Writes C to the vga display and serial port.
@@ -189,3 +208,19 @@ putchar_have_lock (uint8_t c)
   serial_putc (c);
   vga_putc (c);
 }
+
+/* Writes the N characters in BUFFER to the vga display and
+   serial port, handing them to the serial port all at once.
+   The caller has already acquired the console lock if
+   appropriate. */
+static void
+putbuf_have_lock (const char *buffer, size_t n) 
+{
+  size_t i;
+
+  ASSERT (console_locked_by_current_thread ());
+  write_cnt += n;
+  serial_write (buffer, n);
+  for (i = 0; i < n; i++)
+    vga_putc (buffer[i]);
+}
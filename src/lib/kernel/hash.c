@@ -12,12 +12,25 @@
 #define list_elem_to_hash_elem(LIST_ELEM)                       \
         list_entry(LIST_ELEM, struct hash_elem, list_elem)
 
+/* A slot in an open-addressed table. */
+struct hash_slot
+  {
+    unsigned hash;              /* Hash value of `elem'. */
+    struct hash_elem *elem;     /* Element, or null if slot is empty. */
+  };
+
 static struct list *find_bucket (struct hash *, struct hash_elem *);
 static struct hash_elem *find_elem (struct hash *, struct list *,
                                     struct hash_elem *);
 static void insert_elem (struct hash *, struct list *, struct hash_elem *);
 static void remove_elem (struct hash *, struct hash_elem *);
+static struct list *next_bucket (struct hash *, struct list *);
 static void rehash (struct hash *);
+static void finish_rehash (struct hash *);
+
+static size_t find_slot (struct hash *, struct hash_elem *, unsigned hash);
+static void remove_slot (struct hash *, size_t);
+static void resize_slots (struct hash *, size_t slot_cnt);
 
 /* Initializes hash table H to compute hash values using HASH and
    compare hash elements using LESS, given auxiliary data AUX. */
@@ -28,6 +41,11 @@ hash_init (struct hash *h,
   h->elem_cnt = 0;
   h->bucket_cnt = 4;
   h->buckets = malloc (sizeof *h->buckets * h->bucket_cnt);
+  h->old_buckets = NULL;
+  h->old_bucket_cnt = 0;
+  h->rehash_idx = 0;
+  h->slots = NULL;
+  h->open = false;
   h->hash = hash;
   h->less = less;
   h->aux = aux;
@@ -41,6 +59,33 @@ hash_init (struct hash *h,
     return false;
 }
 
+/* Initializes hash table H like hash_init(), but to use open
+   addressing instead of chained buckets.  See hash.h. */
+bool
+hash_init_open (struct hash *h,
+                hash_hash_func *hash, hash_less_func *less, void *aux) 
+{
+  h->elem_cnt = 0;
+  h->bucket_cnt = 8;
+  h->buckets = NULL;
+  h->old_buckets = NULL;
+  h->old_bucket_cnt = 0;
+  h->rehash_idx = 0;
+  h->slots = malloc (sizeof *h->slots * h->bucket_cnt);
+  h->open = true;
+  h->hash = hash;
+  h->less = less;
+  h->aux = aux;
+
+  if (h->slots != NULL) 
+    {
+      hash_clear (h, NULL);
+      return true;
+    }
+  else
+    return false;
+}
+
 /* Removes all the elements from H.
    
    If DESTRUCTOR is non-null, then it is called for each element
@@ -55,6 +100,22 @@ hash_clear (struct hash *h, hash_action_func *destructor)
 {
   size_t i;
 
+  if (h->open)
+    {
+      for (i = 0; i < h->bucket_cnt; i++)
+        {
+          if (destructor != NULL && h->slots[i].elem != NULL)
+            destructor (h->slots[i].elem, h->aux);
+          h->slots[i].elem = NULL;
+        }
+      h->elem_cnt = 0;
+      return;
+    }
+
+  /* Elements not yet rehashed are still in the old buckets.
+     Finish moving them so there is only one array to clear. */
+  finish_rehash (h);
+
   for (i = 0; i < h->bucket_cnt; i++) 
     {
       struct list *bucket = &h->buckets[i];
@@ -89,18 +150,49 @@ hash_destroy (struct hash *h, hash_action_func *destructor)
   if (destructor != NULL)
     hash_clear (h, destructor);
   free (h->buckets);
+  free (h->old_buckets);
+  free (h->slots);
 }
 
 /* Inserts NEW into hash table H and returns a null pointer, if
    no equal element is already in the table.
    If an equal element is already in the table, returns it
-   without inserting NEW. */   
+   without inserting NEW.
+   An open-addressed table that is full and cannot grow for lack
+   of memory returns NEW itself without inserting it. */   
 struct hash_elem *
 hash_insert (struct hash *h, struct hash_elem *new)
 {
-  struct list *bucket = find_bucket (h, new);
-  struct hash_elem *old = find_elem (h, bucket, new);
+  struct list *bucket;
+  struct hash_elem *old;
+
+  if (h->open)
+    {
+      unsigned hash = h->hash (new, h->aux);
+      size_t idx = find_slot (h, new, hash);
 
+      if (h->slots[idx].elem != NULL)
+        return h->slots[idx].elem;
+
+      /* Keep the table at most 3/4 full, so that probe sequences
+         stay short.  If memory is short, go on filling the slots
+         we have, with longer probes, but always leave one slot
+         empty so that a probe for a missing element ends. */
+      if ((h->elem_cnt + 1) * 4 > h->bucket_cnt * 3)
+        {
+          resize_slots (h, h->bucket_cnt * 2);
+          idx = find_slot (h, new, hash);
+        }
+      if (h->elem_cnt + 1 >= h->bucket_cnt)
+        return new;
+      h->slots[idx].hash = hash;
+      h->slots[idx].elem = new;
+      h->elem_cnt++;
+      return NULL;
+    }
+
+  bucket = find_bucket (h, new);
+  old = find_elem (h, bucket, new);
   if (old == NULL) 
     insert_elem (h, bucket, new);
 
@@ -110,13 +202,28 @@ hash_insert (struct hash *h, struct hash_elem *new)
 }
 
 /* Inserts NEW into hash table H, replacing any equal element
-   already in the table, which is returned. */
+   already in the table, which is returned.  Like hash_insert(),
+   returns NEW without inserting it if H is an open-addressed
+   table that is full and cannot grow. */
 struct hash_elem *
 hash_replace (struct hash *h, struct hash_elem *new) 
 {
-  struct list *bucket = find_bucket (h, new);
-  struct hash_elem *old = find_elem (h, bucket, new);
+  struct list *bucket;
+  struct hash_elem *old;
+
+  if (h->open)
+    {
+      size_t idx = find_slot (h, new, h->hash (new, h->aux));
 
+      old = h->slots[idx].elem;
+      if (old == NULL)
+        return hash_insert (h, new);
+      h->slots[idx].elem = new;
+      return old;
+    }
+
+  bucket = find_bucket (h, new);
+  old = find_elem (h, bucket, new);
   if (old != NULL)
     remove_elem (h, old);
   insert_elem (h, bucket, new);
@@ -131,6 +238,8 @@ hash_replace (struct hash *h, struct hash_elem *new)
 struct hash_elem *
 hash_find (struct hash *h, struct hash_elem *e) 
 {
+  if (h->open)
+    return h->slots[find_slot (h, e, h->hash (e, h->aux))].elem;
   return find_elem (h, find_bucket (h, e), e);
 }
 
@@ -144,7 +253,23 @@ hash_find (struct hash *h, struct hash_elem *e)
 struct hash_elem *
 hash_delete (struct hash *h, struct hash_elem *e)
 {
-  struct hash_elem *found = find_elem (h, find_bucket (h, e), e);
+  struct hash_elem *found;
+
+  if (h->open)
+    {
+      size_t idx = find_slot (h, e, h->hash (e, h->aux));
+
+      found = h->slots[idx].elem;
+      if (found != NULL)
+        {
+          remove_slot (h, idx);
+          if (h->bucket_cnt > 8 && h->elem_cnt * 8 < h->bucket_cnt)
+            resize_slots (h, h->bucket_cnt / 2);
+        }
+      return found;
+    }
+
+  found = find_elem (h, find_bucket (h, e), e);
   if (found != NULL) 
     {
       remove_elem (h, found);
@@ -162,13 +287,22 @@ hash_delete (struct hash *h, struct hash_elem *e)
 void
 hash_apply (struct hash *h, hash_action_func *action) 
 {
-  size_t i;
+  struct list *bucket;
   
   ASSERT (action != NULL);
 
-  for (i = 0; i < h->bucket_cnt; i++) 
+  if (h->open)
+    {
+      size_t i;
+
+      for (i = 0; i < h->bucket_cnt; i++)
+        if (h->slots[i].elem != NULL)
+          action (h->slots[i].elem, h->aux);
+      return;
+    }
+
+  for (bucket = h->buckets; bucket != NULL; bucket = next_bucket (h, bucket))
     {
-      struct list *bucket = &h->buckets[i];
       struct list_elem *elem, *next;
 
       for (elem = list_begin (bucket); elem != list_end (bucket); elem = next) 
@@ -203,6 +337,13 @@ hash_first (struct hash_iterator *i, struct hash *h)
   ASSERT (h != NULL);
 
   i->hash = h;
+  if (h->open)
+    {
+      i->bucket = NULL;
+      i->slot = (size_t) -1;
+      i->elem = NULL;
+      return;
+    }
   i->bucket = i->hash->buckets;
   i->elem = list_elem_to_hash_elem (list_head (i->bucket));
 }
@@ -220,10 +361,27 @@ hash_next (struct hash_iterator *i)
 {
   ASSERT (i != NULL);
 
+  if (i->hash->open)
+    {
+      struct hash *h = i->hash;
+
+      i->elem = NULL;
+      while (++i->slot < h->bucket_cnt)
+        if (h->slots[i->slot].elem != NULL)
+          {
+            i->elem = h->slots[i->slot].elem;
+            break;
+          }
+      if (i->elem == NULL)
+        i->slot = h->bucket_cnt;
+      return i->elem;
+    }
+
   i->elem = list_elem_to_hash_elem (list_next (&i->elem->list_elem));
   while (i->elem == list_elem_to_hash_elem (list_end (i->bucket)))
     {
-      if (++i->bucket >= i->hash->buckets + i->hash->bucket_cnt)
+      i->bucket = next_bucket (i->hash, i->bucket);
+      if (i->bucket == NULL)
         {
           i->elem = NULL;
           break;
@@ -300,13 +458,22 @@ hash_int (int i)
 {
   return hash_bytes (&i, sizeof i);
 }
-
-/* Returns the bucket in H that E belongs in. */
+
+/* Returns the bucket in H that E belongs in.  While H is being
+   rehashed, that is an old bucket if E's old bucket has not been
+   moved yet. */
 static struct list *
 find_bucket (struct hash *h, struct hash_elem *e) 
 {
-  size_t bucket_idx = h->hash (e, h->aux) & (h->bucket_cnt - 1);
-  return &h->buckets[bucket_idx];
+  unsigned hash = h->hash (e, h->aux);
+
+  if (h->old_buckets != NULL)
+    {
+      size_t old_idx = hash & (h->old_bucket_cnt - 1);
+      if (old_idx >= h->rehash_idx)
+        return &h->old_buckets[old_idx];
+    }
+  return &h->buckets[hash & (h->bucket_cnt - 1)];
 }
 
 /* Searches BUCKET in H for a hash element equal to E.  Returns
@@ -325,6 +492,23 @@ find_elem (struct hash *h, struct list *bucket, struct hash_elem *e)
   return NULL;
 }
 
+/* Returns the bucket in H that follows BUCKET in iteration order,
+   or a null pointer if BUCKET is the last.  The current buckets
+   come first, then any old buckets not yet rehashed. */
+static struct list *
+next_bucket (struct hash *h, struct list *bucket) 
+{
+  if (bucket >= h->buckets && bucket < h->buckets + h->bucket_cnt)
+    {
+      if (++bucket < h->buckets + h->bucket_cnt)
+        return bucket;
+      if (h->old_buckets == NULL || h->rehash_idx >= h->old_bucket_cnt)
+        return NULL;
+      return &h->old_buckets[h->rehash_idx];
+    }
+  return ++bucket < h->old_buckets + h->old_bucket_cnt ? bucket : NULL;
+}
+
 /* Returns X with its lowest-order bit set to 1 turned off. */
 static inline size_t
 turn_off_least_1bit (size_t x) 
@@ -344,72 +528,103 @@ is_power_of_2 (size_t x)
 #define BEST_ELEMS_PER_BUCKET 2 /* Ideal elems/bucket. */
 #define MAX_ELEMS_PER_BUCKET  4 /* Elems/bucket > 4: increase # of buckets. */
 
+/* Number of old buckets moved to the new bucket array by each
+   call to rehash().  Moving at least two per call finishes a
+   rehash before the table can need another one. */
+#define REHASH_STEP 4
+
+/* Moves the elements in old bucket OLD_BUCKET of H into H's
+   current buckets. */
+static void
+move_bucket (struct hash *h, struct list *old_bucket) 
+{
+  while (!list_empty (old_bucket)) 
+    {
+      struct list_elem *elem = list_pop_front (old_bucket);
+      unsigned hash = h->hash (list_elem_to_hash_elem (elem), h->aux);
+      list_push_front (&h->buckets[hash & (h->bucket_cnt - 1)], elem);
+    }
+}
+
 /* Changes the number of buckets in hash table H to match the
-   ideal.  This function can fail because of an out-of-memory
+   ideal, a little at a time.  If H is not already being rehashed
+   and its bucket count is far from ideal, installs a new, empty
+   bucket array and keeps the old one.  Then moves up to
+   REHASH_STEP old buckets' elements into the new array, freeing
+   the old array once it is empty.  Lookups in the meantime
+   consult whichever array holds the element's bucket (see
+   find_bucket()).
+
+   This function can fail because of an out-of-memory
    condition, but that'll just make hash accesses less efficient;
    we can still continue. */
 static void
 rehash (struct hash *h) 
 {
-  size_t old_bucket_cnt, new_bucket_cnt;
-  struct list *new_buckets, *old_buckets;
   size_t i;
 
   ASSERT (h != NULL);
 
-  /* Save old bucket info for later use. */
-  old_buckets = h->buckets;
-  old_bucket_cnt = h->bucket_cnt;
-
-  /* Calculate the number of buckets to use now.
-     We want one bucket for about every BEST_ELEMS_PER_BUCKET.
-     We must have at least four buckets, and the number of
-     buckets must be a power of 2. */
-  new_bucket_cnt = h->elem_cnt / BEST_ELEMS_PER_BUCKET;
-  if (new_bucket_cnt < 4)
-    new_bucket_cnt = 4;
-  while (!is_power_of_2 (new_bucket_cnt))
-    new_bucket_cnt = turn_off_least_1bit (new_bucket_cnt);
-
-  /* Don't do anything if the bucket count wouldn't change. */
-  if (new_bucket_cnt == old_bucket_cnt)
-    return;
-
-  /* Allocate new buckets and initialize them as empty. */
-  new_buckets = malloc (sizeof *new_buckets * new_bucket_cnt);
-  if (new_buckets == NULL) 
+  if (h->old_buckets == NULL) 
     {
-      /* Allocation failed.  This means that use of the hash table will
-         be less efficient.  However, it is still usable, so
-         there's no reason for it to be an error. */
-      return;
+      size_t new_bucket_cnt;
+      struct list *new_buckets;
+
+      /* Calculate the number of buckets to use now.
+         We want one bucket for about every BEST_ELEMS_PER_BUCKET.
+         We must have at least four buckets, and the number of
+         buckets must be a power of 2. */
+      new_bucket_cnt = h->elem_cnt / BEST_ELEMS_PER_BUCKET;
+      if (new_bucket_cnt < 4)
+        new_bucket_cnt = 4;
+      while (!is_power_of_2 (new_bucket_cnt))
+        new_bucket_cnt = turn_off_least_1bit (new_bucket_cnt);
+
+      /* Don't do anything if the bucket count wouldn't change. */
+      if (new_bucket_cnt == h->bucket_cnt)
+        return;
+
+      /* Allocate new buckets and initialize them as empty. */
+      new_buckets = malloc (sizeof *new_buckets * new_bucket_cnt);
+      if (new_buckets == NULL) 
+        {
+          /* Allocation failed.  This means that use of the hash
+             table will be less efficient.  However, it is still
+             usable, so there's no reason for it to be an
+             error. */
+          return;
+        }
+      for (i = 0; i < new_bucket_cnt; i++) 
+        list_init (&new_buckets[i]);
+
+      /* Install new bucket info, keeping the old buckets until
+         their elements have all been moved. */
+      h->old_buckets = h->buckets;
+      h->old_bucket_cnt = h->bucket_cnt;
+      h->rehash_idx = 0;
+      h->buckets = new_buckets;
+      h->bucket_cnt = new_bucket_cnt;
     }
-  for (i = 0; i < new_bucket_cnt; i++) 
-    list_init (&new_buckets[i]);
 
-  /* Install new bucket info. */
-  h->buckets = new_buckets;
-  h->bucket_cnt = new_bucket_cnt;
+  /* Move a few old buckets' elements into the new buckets. */
+  for (i = 0; i < REHASH_STEP && h->rehash_idx < h->old_bucket_cnt; i++)
+    move_bucket (h, &h->old_buckets[h->rehash_idx++]);
 
-  /* Move each old element into the appropriate new bucket. */
-  for (i = 0; i < old_bucket_cnt; i++) 
+  if (h->rehash_idx >= h->old_bucket_cnt)
     {
-      struct list *old_bucket;
-      struct list_elem *elem, *next;
-
-      old_bucket = &old_buckets[i];
-      for (elem = list_begin (old_bucket);
-           elem != list_end (old_bucket); elem = next) 
-        {
-          struct list *new_bucket
-            = find_bucket (h, list_elem_to_hash_elem (elem));
-          next = list_next (elem);
-          list_remove (elem);
-          list_push_front (new_bucket, elem);
-        }
+      free (h->old_buckets);
+      h->old_buckets = NULL;
+      h->old_bucket_cnt = 0;
+      h->rehash_idx = 0;
     }
+}
 
-  free (old_buckets);
+/* Completes any rehash of H that is in progress. */
+static void
+finish_rehash (struct hash *h) 
+{
+  while (h->old_buckets != NULL)
+    rehash (h);
 }
 
 /* Inserts E into BUCKET (in hash table H). */
@@ -428,3 +643,87 @@ remove_elem (struct hash *h, struct hash_elem *e)
   list_remove (&e->list_elem);
 }
 
+/* Returns the index of the slot in open-addressed table H that
+   holds an element equal to E, whose hash value is HASH, or of
+   the empty slot where E would be inserted if there is no such
+   element.  Probes linearly from E's home slot, comparing full
+   hash values before calling the comparison function. */
+static size_t
+find_slot (struct hash *h, struct hash_elem *e, unsigned hash) 
+{
+  size_t mask = h->bucket_cnt - 1;
+  size_t idx;
+
+  for (idx = hash & mask; h->slots[idx].elem != NULL; idx = (idx + 1) & mask)
+    {
+      struct hash_slot *s = &h->slots[idx];
+      if (s->hash == hash
+          && !h->less (s->elem, e, h->aux) && !h->less (e, s->elem, h->aux))
+        break;
+    }
+  return idx;
+}
+
+/* Empties slot IDX of open-addressed table H.  Later elements in
+   the same probe run are shifted back into the gap, so that
+   lookups never need to skip over deleted slots. */
+static void
+remove_slot (struct hash *h, size_t idx) 
+{
+  size_t mask = h->bucket_cnt - 1;
+  size_t next = idx;
+
+  h->elem_cnt--;
+  for (;;)
+    {
+      size_t home;
+
+      next = (next + 1) & mask;
+      if (h->slots[next].elem == NULL)
+        break;
+
+      /* The element in NEXT may stay if its home slot lies
+         cyclically after the gap and at or before NEXT. */
+      home = h->slots[next].hash & mask;
+      if (idx <= next ? idx < home && home <= next : idx < home || home <= next)
+        continue;
+
+      h->slots[idx] = h->slots[next];
+      idx = next;
+    }
+  h->slots[idx].elem = NULL;
+}
+
+/* Changes open-addressed table H to have SLOT_CNT slots, a power
+   of 2, reinserting every element by its saved hash value.  Like
+   rehash(), quietly keeps the old size if memory is short. */
+static void
+resize_slots (struct hash *h, size_t slot_cnt) 
+{
+  struct hash_slot *old_slots = h->slots;
+  size_t old_slot_cnt = h->bucket_cnt;
+  struct hash_slot *new_slots;
+  size_t i;
+
+  ASSERT (is_power_of_2 (slot_cnt));
+  ASSERT (slot_cnt > h->elem_cnt);
+
+  new_slots = malloc (sizeof *new_slots * slot_cnt);
+  if (new_slots == NULL)
+    return;
+  for (i = 0; i < slot_cnt; i++)
+    new_slots[i].elem = NULL;
+
+  for (i = 0; i < old_slot_cnt; i++)
+    if (old_slots[i].elem != NULL)
+      {
+        size_t idx = old_slots[i].hash & (slot_cnt - 1);
+        while (new_slots[idx].elem != NULL)
+          idx = (idx + 1) & (slot_cnt - 1);
+        new_slots[idx] = old_slots[i];
+      }
+
+  h->slots = new_slots;
+  h->bucket_cnt = slot_cnt;
+  free (old_slots);
+}
@@ -18,7 +18,24 @@
    conversion from a struct hash_elem back to a structure object
    that contains it.  This is the same technique used in the
    linked list implementation.  Refer to lib/kernel/list.h for a
-   detailed explanation. */
+   detailed explanation.
+
+   When the table grows or shrinks, its elements move to the new
+   bucket array a few buckets at a time, as a side effect of
+   later insertions and deletions, rather than all at once.  That
+   keeps the cost of any single operation small no matter how big
+   the table is.
+
+   A table initialized with hash_init_open() instead uses open
+   addressing: an array of slots, each holding an element's hash
+   value and a pointer to the element, probed linearly.  Lookups
+   then touch consecutive memory and compare full hash values
+   before calling the comparison function.  Such a table is used
+   through the same functions and the same struct hash_elem, but
+   it still resizes all at once.  If it cannot grow for lack of
+   memory it keeps filling its current slots; only once they are
+   all used does hash_insert() fail, by returning the new element
+   itself. */
 
 #include <stdbool.h>
 #include <stddef.h>
@@ -61,6 +78,11 @@ struct hash
     size_t elem_cnt;            /* Number of elements in table. */
     size_t bucket_cnt;          /* Number of buckets, a power of 2. */
     struct list *buckets;       /* Array of `bucket_cnt' lists. */
+    struct list *old_buckets;   /* Buckets being rehashed, or null. */
+    size_t old_bucket_cnt;      /* Number of `old_buckets'. */
+    size_t rehash_idx;          /* First old bucket not yet rehashed. */
+    struct hash_slot *slots;    /* Open addressing: `bucket_cnt' slots. */
+    bool open;                  /* Open addressing instead of chaining? */
     hash_hash_func *hash;       /* Hash function. */
     hash_less_func *less;       /* Comparison function. */
     void *aux;                  /* Auxiliary data for `hash' and `less'. */
@@ -71,11 +93,14 @@ struct hash_iterator
   {
     struct hash *hash;          /* The hash table. */
     struct list *bucket;        /* Current bucket. */
+    size_t slot;                /* Current slot, for open addressing. */
     struct hash_elem *elem;     /* Current hash element in current bucket. */
   };
 
 /* Basic life cycle. */
 bool hash_init (struct hash *, hash_hash_func *, hash_less_func *, void *aux);
+bool hash_init_open (struct hash *, hash_hash_func *, hash_less_func *,
+                     void *aux);
 void hash_clear (struct hash *, hash_action_func *);
 void hash_destroy (struct hash *, hash_action_func *);
 
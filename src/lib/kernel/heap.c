@@ -0,0 +1,190 @@
+#include "heap.h"
+#include "../debug.h"
+
+/* Our heap is a pairing heap: each element's children hang off
+   its `child' member as a doubly linked list of siblings, and
+   every element compares before all of its children.  Two heaps
+   are combined by making the root that comes later the first
+   child of the other.  Popping the root leaves a list of
+   subheaps, which are combined pairwise from left to right and
+   then one by one from right to left; this is what makes the
+   amortized cost logarithmic.
+
+   All the loops are iterative, so the depth of the tree doesn't
+   matter to the kernel's small stacks. */
+
+/* Returns true if A must come out of H before B: if A is less
+   than B, or if they are equal and A was inserted first. */
+static inline bool
+comes_before (struct heap *h, const struct heap_elem *a,
+              const struct heap_elem *b)
+{
+  if (h->less (a, b, h->aux))
+    return true;
+  else if (h->less (b, a, h->aux))
+    return false;
+  else
+    return (int) (a->seq - b->seq) < 0;
+}
+
+/* Combines the heaps rooted at A and B and returns the new root.
+   The `next' and `prev' members of the result are undefined. */
+static struct heap_elem *
+link (struct heap *h, struct heap_elem *a, struct heap_elem *b)
+{
+  if (comes_before (h, b, a))
+    {
+      struct heap_elem *t = a;
+      a = b;
+      b = t;
+    }
+
+  b->next = a->child;
+  if (b->next != NULL)
+    b->next->prev = b;
+  b->prev = a;
+  a->child = b;
+  return a;
+}
+
+/* Combines the list of sibling heaps that starts at FIRST into
+   a single heap and returns its root. */
+static struct heap_elem *
+merge_pairs (struct heap *h, struct heap_elem *first)
+{
+  struct heap_elem *pairs = NULL;
+  struct heap_elem *root;
+
+  /* Link siblings in pairs from left to right, pushing each
+     result onto PAIRS through its `next' member. */
+  while (first != NULL)
+    {
+      struct heap_elem *a = first;
+      struct heap_elem *b = a->next;
+
+      if (b != NULL)
+        {
+          first = b->next;
+          a = link (h, a, b);
+        }
+      else
+        first = NULL;
+      a->next = pairs;
+      pairs = a;
+    }
+
+  /* Link the pairs from right to left. */
+  root = pairs;
+  pairs = pairs->next;
+  while (pairs != NULL)
+    {
+      struct heap_elem *next = pairs->next;
+      root = link (h, root, pairs);
+      pairs = next;
+    }
+
+  root->next = root->prev = NULL;
+  return root;
+}
+
+/* Initializes H as an empty heap ordered by LESS, given
+   auxiliary data AUX. */
+void
+heap_init (struct heap *h, heap_less_func *less, void *aux)
+{
+  ASSERT (h != NULL);
+  ASSERT (less != NULL);
+
+  h->root = NULL;
+  h->elem_cnt = 0;
+  h->seq = 0;
+  h->less = less;
+  h->aux = aux;
+}
+
+/* Inserts E into H. */
+void
+heap_insert (struct heap *h, struct heap_elem *e)
+{
+  ASSERT (h != NULL);
+  ASSERT (e != NULL);
+
+  e->child = e->next = e->prev = NULL;
+  e->seq = h->seq++;
+  if (h->root != NULL)
+    {
+      h->root = link (h, h->root, e);
+      h->root->next = h->root->prev = NULL;
+    }
+  else
+    h->root = e;
+  h->elem_cnt++;
+}
+
+/* Returns the element that comes first in H, without removing
+   it.  Undefined behavior if H is empty. */
+struct heap_elem *
+heap_top (struct heap *h)
+{
+  ASSERT (!heap_empty (h));
+  return h->root;
+}
+
+/* Removes and returns the element that comes first in H.
+   Undefined behavior if H is empty. */
+struct heap_elem *
+heap_pop (struct heap *h)
+{
+  struct heap_elem *top;
+
+  ASSERT (!heap_empty (h));
+
+  top = h->root;
+  h->root = top->child != NULL ? merge_pairs (h, top->child) : NULL;
+  h->elem_cnt--;
+  return top;
+}
+
+/* Removes E, which must be in H, from H. */
+void
+heap_remove (struct heap *h, struct heap_elem *e)
+{
+  ASSERT (!heap_empty (h));
+  ASSERT (e != NULL);
+
+  if (e == h->root)
+    {
+      heap_pop (h);
+      return;
+    }
+
+  /* Unlink E, with its subheap, from its parent and siblings. */
+  if (e->prev->child == e)
+    e->prev->child = e->next;
+  else
+    e->prev->next = e->next;
+  if (e->next != NULL)
+    e->next->prev = e->prev;
+
+  /* Put E's children back. */
+  if (e->child != NULL)
+    {
+      h->root = link (h, h->root, merge_pairs (h, e->child));
+      h->root->next = h->root->prev = NULL;
+    }
+  h->elem_cnt--;
+}
+
+/* Returns the number of elements in H. */
+size_t
+heap_size (struct heap *h)
+{
+  return h->elem_cnt;
+}
+
+/* Returns true if H is empty, false otherwise. */
+bool
+heap_empty (struct heap *h)
+{
+  return h->root == NULL;
+}
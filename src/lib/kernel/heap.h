@@ -0,0 +1,93 @@
+#ifndef __LIB_KERNEL_HEAP_H
+#define __LIB_KERNEL_HEAP_H
+
+/* Priority queue.
+
+   This is a pairing heap: a tree in which every element comes
+   before all of its descendants, linked through the elements
+   themselves.  Like a list or hash table, it needs no
+   dynamically allocated memory.  Each structure that can be in a
+   heap embeds a struct heap_elem member, and the heap_entry
+   macro converts a struct heap_elem back to the structure that
+   contains it.
+
+   For example, a queue of `struct foo' ordered by `key':
+
+      struct foo
+        {
+          struct heap_elem elem;
+          int key;
+        };
+
+      static bool
+      foo_less (const struct heap_elem *a, const struct heap_elem *b,
+                void *aux UNUSED)
+      {
+        return (heap_entry (a, struct foo, elem)->key
+                < heap_entry (b, struct foo, elem)->key);
+      }
+
+      struct heap foo_heap;
+
+      heap_init (&foo_heap, foo_less, NULL);
+      heap_insert (&foo_heap, &f->elem);
+      ...
+      f = heap_entry (heap_pop (&foo_heap), struct foo, elem);
+
+   heap_insert() takes O(1) time.  heap_pop() and heap_remove()
+   take O(lg n) amortized time, against O(n) to keep a list in
+   order with list_insert_ordered().  Elements that compare equal
+   come out in the order they were inserted, so a heap whose
+   elements all compare equal behaves as a FIFO queue. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Heap element. */
+struct heap_elem
+  {
+    struct heap_elem *child;    /* First child. */
+    struct heap_elem *next;     /* Next sibling. */
+    struct heap_elem *prev;     /* Previous sibling, or parent if first
+                                   child, or null if root. */
+    unsigned seq;               /* Insertion order, for ties. */
+  };
+
+/* Compares the value of two heap elements A and B, given
+   auxiliary data AUX.  Returns true if A must come out of the
+   heap before B, false otherwise. */
+typedef bool heap_less_func (const struct heap_elem *a,
+                             const struct heap_elem *b,
+                             void *aux);
+
+/* Heap. */
+struct heap
+  {
+    struct heap_elem *root;     /* First element, or null if empty. */
+    size_t elem_cnt;            /* Number of elements. */
+    unsigned seq;               /* Insertion count. */
+    heap_less_func *less;       /* Comparison function. */
+    void *aux;                  /* Auxiliary data for `less'. */
+  };
+
+/* Converts pointer to heap element HEAP_ELEM into a pointer to
+   the structure that HEAP_ELEM is embedded inside.  Supply the
+   name of the outer structure STRUCT and the member name MEMBER
+   of the heap element.  See the big comment at the top of the
+   file for an example. */
+#define heap_entry(HEAP_ELEM, STRUCT, MEMBER)                   \
+        ((STRUCT *) ((uint8_t *) &(HEAP_ELEM)->next             \
+                     - offsetof (STRUCT, MEMBER.next)))
+
+void heap_init (struct heap *, heap_less_func *, void *aux);
+
+void heap_insert (struct heap *, struct heap_elem *);
+struct heap_elem *heap_top (struct heap *);
+struct heap_elem *heap_pop (struct heap *);
+void heap_remove (struct heap *, struct heap_elem *);
+
+size_t heap_size (struct heap *);
+bool heap_empty (struct heap *);
+
+#endif /* lib/kernel/heap.h */
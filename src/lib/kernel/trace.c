@@ -0,0 +1,204 @@
+#include <trace.h>
+#include <debug.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/timer.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/tsc.h"
+#include "threads/vaddr.h"
+#ifdef FILESYS
+#include "devices/block.h"
+#include "filesys/fsutil.h"
+#endif
+
+/* Pages given to the trace buffer, header included. */
+#define TRACE_PAGES 16
+
+/* Identifies a trace dump.  Spells "PTRC" in memory. */
+#define TRACE_MAGIC 0x43525450
+#define TRACE_VERSION 1
+
+/* Start of a trace dump.  utils/trace-decode depends on the
+   layout of this structure and of struct trace_entry. */
+struct trace_header
+  {
+    uint32_t magic;             /* TRACE_MAGIC. */
+    uint16_t version;           /* TRACE_VERSION. */
+    uint16_t entry_size;        /* sizeof (struct trace_entry). */
+    uint32_t entry_cnt;         /* Number of slots in the ring. */
+    uint32_t head;              /* Number of slots ever claimed. */
+    uint32_t mask;              /* Subsystems that were traced. */
+    uint32_t timer_freq;        /* Timer ticks per second. */
+    uint32_t unused[2];         /* Pads header to one entry. */
+  };
+
+/* One recorded event. */
+struct trace_entry
+  {
+    uint32_t seq;               /* Claim number plus 1, 0 if unused. */
+    uint16_t event;             /* Event ID. */
+    uint16_t tid;               /* Running thread. */
+    uint64_t tsc;               /* Time stamp counter. */
+    uint32_t ticks;             /* Timer ticks since boot. */
+    uint32_t args[3];           /* Event arguments. */
+  };
+
+/* Bit (1 << SUBSYS) is set if SUBSYS is being traced. */
+uint32_t trace_mask;
+
+/* Subsystem names accepted by "-trace=". */
+static const char *subsys_names[TRACE_SUBSYS_CNT] =
+  {
+    [TRACE_THREAD] = "thread",
+    [TRACE_INTR] = "intr",
+    [TRACE_SYSCALL] = "syscall",
+    [TRACE_PROCESS] = "process",
+    [TRACE_FILESYS] = "filesys",
+  };
+
+/* Trace buffer: a header followed by the ring of entries.
+   Null until trace_init() succeeds. */
+static struct trace_header *trace_hdr;
+static struct trace_entry *trace_entries;
+static uint32_t trace_entry_cnt;
+
+/* True to dump the ring at shutdown. */
+static bool dump_requested;
+
+/* Enables tracing of the comma-separated SUBSYSTEMS, which may
+   include "all".  Called while parsing the kernel command line,
+   before memory is available, so it only sets the mask.  Panics
+   on an unknown subsystem name. */
+void
+trace_configure (char *subsystems)
+{
+  char *name, *save_ptr;
+
+  if (subsystems == NULL)
+    PANIC ("-trace requires a list of subsystems");
+  for (name = strtok_r (subsystems, ",", &save_ptr); name != NULL;
+       name = strtok_r (NULL, ",", &save_ptr))
+    {
+      int i;
+
+      if (!strcmp (name, "all"))
+        {
+          trace_mask = (1u << TRACE_SUBSYS_CNT) - 1;
+          continue;
+        }
+      for (i = 0; i < TRACE_SUBSYS_CNT; i++)
+        if (!strcmp (name, subsys_names[i]))
+          break;
+      if (i >= TRACE_SUBSYS_CNT)
+        PANIC ("unknown trace subsystem `%s'", name);
+      trace_mask |= 1u << i;
+    }
+}
+
+/* Arranges for trace_dump() to write out the ring. */
+void
+trace_request_dump (void)
+{
+  dump_requested = true;
+}
+
+/* Allocates the trace buffer if any subsystem is being traced.
+   Events recorded before this point are dropped. */
+void
+trace_init (void)
+{
+  if (trace_mask == 0)
+    return;
+
+  trace_hdr = palloc_get_multiple (PAL_ZERO, TRACE_PAGES);
+  if (trace_hdr == NULL)
+    {
+      printf ("trace: no memory for buffer, tracing disabled\n");
+      trace_mask = 0;
+      return;
+    }
+  trace_entry_cnt = (TRACE_PAGES * PGSIZE - sizeof *trace_hdr)
+                    / sizeof *trace_entries;
+
+  trace_hdr->magic = TRACE_MAGIC;
+  trace_hdr->version = TRACE_VERSION;
+  trace_hdr->entry_size = sizeof *trace_entries;
+  trace_hdr->entry_cnt = trace_entry_cnt;
+  trace_hdr->mask = trace_mask;
+  trace_hdr->timer_freq = TIMER_FREQ;
+  barrier ();
+  trace_entries = (struct trace_entry *) (trace_hdr + 1);
+}
+
+/* Records EVENT with arguments A0, A1, A2.  Callers normally use
+   the TRACE macro, which checks the subsystem mask first. */
+void
+trace_record (unsigned event, uint32_t a0, uint32_t a1, uint32_t a2)
+{
+  struct trace_entry *e;
+  uint32_t seq;
+
+  if (trace_entries == NULL)
+    return;
+
+  /* Claim a slot.  An interrupt handler that traces between here
+     and the store to E->seq claims the following slot, so the
+     two entries never overlap. */
+  seq = 1;
+  asm volatile ("lock xaddl %0, %1"
+                : "+r" (seq), "+m" (trace_hdr->head) : : "memory");
+  e = &trace_entries[seq % trace_entry_cnt];
+
+  /* Mark the slot incomplete, fill it in, then publish it. */
+  e->seq = 0;
+  barrier ();
+  e->event = event;
+  e->tid = thread_current ()->tid;
+  e->tsc = read_tsc ();
+  e->ticks = timer_ticks ();
+  e->args[0] = a0;
+  e->args[1] = a1;
+  e->args[2] = a2;
+  barrier ();
+  e->seq = seq + 1;
+}
+
+/* Appends the trace buffer to the scratch device as "trace", if
+   a dump was requested.  Called at shutdown. */
+void
+trace_dump (void)
+{
+#ifdef FILESYS
+  if (!dump_requested)
+    return;
+  dump_requested = false;
+
+  if (trace_hdr == NULL)
+    printf ("trace: nothing traced, not dumping\n");
+  else if (block_get_role (BLOCK_SCRATCH) == NULL)
+    printf ("trace: no scratch device, not dumping\n");
+  else
+    {
+      /* Stop recording so the ring doesn't change under us. */
+      trace_mask = 0;
+      fsutil_append_buffer ("trace", trace_hdr, TRACE_PAGES * PGSIZE);
+    }
+#endif
+}
+
+/* Prints tracing statistics. */
+void
+trace_print_stats (void)
+{
+  uint32_t head;
+
+  if (trace_hdr == NULL)
+    return;
+  head = trace_hdr->head;
+  printf ("Trace: %"PRIu32" events, %"PRIu32" overwritten\n",
+          head, head > trace_entry_cnt ? head - trace_entry_cnt : 0);
+}
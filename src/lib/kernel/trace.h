@@ -0,0 +1,72 @@
+#ifndef __LIB_KERNEL_TRACE_H
+#define __LIB_KERNEL_TRACE_H
+
+#include <stdint.h>
+
+/* Binary event tracing.
+
+   Events are recorded into a fixed-size ring that overwrites its
+   oldest entries once full.  Recording takes no locks: a writer
+   claims a slot with one atomic increment and then fills it in,
+   so trace points may be placed anywhere, including in interrupt
+   handlers, and an interrupt that lands inside a trace point
+   simply records into the next slot.
+
+   Each subsystem is enabled separately with the kernel's
+   "-trace=" option.  A disabled trace point costs a load and a
+   test.  With "-trace-dump", the ring is appended to the scratch
+   device at shutdown, where "pintos --trace=FILE" picks it up for
+   utils/trace-decode. */
+
+/* Subsystems that can be traced. */
+enum trace_subsys
+  {
+    TRACE_THREAD,               /* Thread scheduler. */
+    TRACE_INTR,                 /* External interrupts. */
+    TRACE_SYSCALL,              /* System calls. */
+    TRACE_PROCESS,              /* User processes. */
+    TRACE_FILESYS,              /* File system. */
+    TRACE_SUBSYS_CNT
+  };
+
+/* An event ID holds its subsystem in the high byte. */
+#define TRACE_EVENT(SUBSYS, NUMBER) (((SUBSYS) << 8) | (NUMBER))
+#define TRACE_SUBSYS(EVENT) ((EVENT) >> 8)
+
+/* Events.  The comment lists each event's arguments.
+   utils/trace-decode must be kept in sync with this list. */
+enum trace_event
+  {
+    TRACE_THREAD_SWITCH = TRACE_EVENT (TRACE_THREAD, 0),  /* Old, new tid. */
+    TRACE_INTR_ENTER = TRACE_EVENT (TRACE_INTR, 0),       /* Vector. */
+    TRACE_SYSCALL_ENTER = TRACE_EVENT (TRACE_SYSCALL, 0), /* Number. */
+    TRACE_SYSCALL_EXIT = TRACE_EVENT (TRACE_SYSCALL, 1),  /* Number, ret. */
+    TRACE_PROCESS_EXEC = TRACE_EVENT (TRACE_PROCESS, 0),  /* Child tid. */
+    TRACE_PROCESS_EXIT = TRACE_EVENT (TRACE_PROCESS, 1),  /* Exit code. */
+    TRACE_FILESYS_READ = TRACE_EVENT (TRACE_FILESYS, 0),  /* Sector, ofs,
+                                                             size. */
+    TRACE_FILESYS_WRITE = TRACE_EVENT (TRACE_FILESYS, 1)  /* Sector, ofs,
+                                                             size. */
+  };
+
+/* Bit (1 << SUBSYS) is set if SUBSYS is being traced. */
+extern uint32_t trace_mask;
+
+/* Records EVENT with arguments A0, A1, A2 if its subsystem is
+   enabled. */
+#define TRACE(EVENT, A0, A1, A2)                                \
+        do                                                      \
+          {                                                     \
+            if (trace_mask & (1u << TRACE_SUBSYS (EVENT)))      \
+              trace_record (EVENT, A0, A1, A2);                 \
+          }                                                     \
+        while (0)
+
+void trace_configure (char *subsystems);
+void trace_request_dump (void);
+void trace_init (void);
+void trace_record (unsigned event, uint32_t, uint32_t, uint32_t);
+void trace_dump (void);
+void trace_print_stats (void);
+
+#endif /* lib/kernel/trace.h */
@@ -0,0 +1,65 @@
+#ifndef __LIB_RING_H
+#define __LIB_RING_H
+
+/* Batched system call submission ring, shared by user programs
+   and the kernel.
+
+   A process maps one page holding a struct sq_ring with
+   ring_setup().  It queues requests by filling in sqes[] at
+   sq_tail and advancing sq_tail, then calls ring_enter() once to
+   have the kernel carry out up to a given number of them.  For
+   each request consumed the kernel advances sq_head and posts a
+   completion carrying the request's user_data and result at
+   cq_tail.  The process reaps completions from cq_head.
+
+   Indexes run freely and wrap modulo 2**32; the slot for index I
+   is I % RING_ENTRIES. */
+
+#include <stdint.h>
+
+/* Number of slots in each queue.  Must be a power of 2. */
+#define RING_ENTRIES 64
+
+/* Request opcodes.  Each is carried out exactly as the system
+   call of the same name would be. */
+enum ring_op
+  {
+    RING_OP_NOP,                /* Do nothing; result is 0. */
+    RING_OP_OPEN,               /* open (addr). */
+    RING_OP_CLOSE,              /* close (fd). */
+    RING_OP_READ,               /* read (fd, addr, len). */
+    RING_OP_WRITE,              /* write (fd, addr, len). */
+    RING_OP_PREAD,              /* pread (fd, addr, len, offset). */
+    RING_OP_PWRITE              /* pwrite (fd, addr, len, offset). */
+  };
+
+/* Submission queue entry. */
+struct sq_entry
+  {
+    uint32_t opcode;            /* One of RING_OP_*. */
+    int32_t fd;                 /* File descriptor. */
+    uint32_t addr;              /* Buffer or file name. */
+    uint32_t len;               /* Buffer length. */
+    uint32_t offset;            /* File offset, for pread/pwrite. */
+    uint32_t user_data;         /* Copied into the completion. */
+  };
+
+/* Completion queue entry. */
+struct cq_entry
+  {
+    uint32_t user_data;         /* From the submission. */
+    int32_t res;                /* Result of the request. */
+  };
+
+/* A submission/completion ring.  Fits in one page. */
+struct sq_ring
+  {
+    uint32_t sq_head;           /* Next request the kernel consumes. */
+    uint32_t sq_tail;           /* Next free request slot. */
+    uint32_t cq_head;           /* Next completion the process reaps. */
+    uint32_t cq_tail;           /* Next free completion slot. */
+    struct sq_entry sqes[RING_ENTRIES];
+    struct cq_entry cqes[RING_ENTRIES];
+  };
+
+#endif /* lib/ring.h */
@@ -3,6 +3,8 @@
 #include <random.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
 
 /* Converts a string representation of a signed decimal integer
    in S into an `int', which is returned. */
@@ -52,7 +54,7 @@ compare_thunk (const void *a, const void *b, void *aux)
    using COMPARE.  When COMPARE is passed a pair of elements A
    and B, respectively, it must return a strcmp()-type result,
    i.e. less than zero if A < B, zero if A == B, greater than
-   zero if A > B.  Runs in O(n lg n) time and O(1) space in
+   zero if A > B.  Runs in O(n lg n) time and O(lg n) space in
    CNT. */
 void
 qsort (void *array, size_t cnt, size_t size,
@@ -61,20 +63,35 @@ qsort (void *array, size_t cnt, size_t size,
   sort (array, cnt, size, compare_thunk, &compare);
 }
 
-/* Swaps elements with 1-based indexes A_IDX and B_IDX in ARRAY
-   with elements of SIZE bytes each. */
+/* Swaps the SIZE-byte elements at A and B.  Elements that are
+   word-aligned and a whole number of words long are swapped a
+   word at a time. */
 static void
-do_swap (unsigned char *array, size_t a_idx, size_t b_idx, size_t size)
+do_swap (unsigned char *a, unsigned char *b, size_t size)
 {
-  unsigned char *a = array + (a_idx - 1) * size;
-  unsigned char *b = array + (b_idx - 1) * size;
-  size_t i;
+  if (((uintptr_t) a | (uintptr_t) b | size) % sizeof (uint32_t) == 0)
+    {
+      uint32_t *wa = (uint32_t *) a;
+      uint32_t *wb = (uint32_t *) b;
+      size_t i;
 
-  for (i = 0; i < size; i++)
+      for (i = 0; i < size / sizeof (uint32_t); i++)
+        {
+          uint32_t t = wa[i];
+          wa[i] = wb[i];
+          wb[i] = t;
+        }
+    }
+  else
     {
-      unsigned char t = a[i];
-      a[i] = b[i];
-      b[i] = t;
+      size_t i;
+
+      for (i = 0; i < size; i++)
+        {
+          unsigned char t = a[i];
+          a[i] = b[i];
+          b[i] = t;
+        }
     }
 }
 
@@ -117,37 +134,185 @@ heapify (unsigned char *array, size_t i, size_t cnt, size_t size,
         break;
 
       /* Swap and continue down the heap. */
-      do_swap (array, i, max, size);
+      do_swap (array + (i - 1) * size, array + (max - 1) * size, size);
       i = max;
     }
 }
 
+/* Sorts ARRAY, which contains CNT elements of SIZE bytes each,
+   by heapsort, using COMPARE to compare elements, passing AUX as
+   auxiliary data. */
+static void
+heap_sort (unsigned char *array, size_t cnt, size_t size,
+           int (*compare) (const void *, const void *, void *aux),
+           void *aux) 
+{
+  size_t i;
+
+  /* Build a heap. */
+  for (i = cnt / 2; i > 0; i--)
+    heapify (array, i, cnt, size, compare, aux);
+
+  /* Sort the heap. */
+  for (i = cnt; i > 1; i--) 
+    {
+      do_swap (array, array + (i - 1) * size, size);
+      heapify (array, 1, i - 1, size, compare, aux); 
+    }
+}
+
+/* Sorts the elements of SIZE bytes each from FIRST up to and
+   including LAST by insertion sort, using COMPARE to compare
+   elements, passing AUX as auxiliary data. */
+static void
+insertion_sort (unsigned char *first, unsigned char *last, size_t size,
+                int (*compare) (const void *, const void *, void *aux),
+                void *aux) 
+{
+  unsigned char *i, *j;
+
+  for (i = first + size; i <= last; i += size)
+    for (j = i; j > first && compare (j - size, j, aux) > 0; j -= size)
+      do_swap (j - size, j, size);
+}
+
+/* Partitions of this many elements or fewer are left to
+   insertion sort. */
+#define INSERTION_SORT_MAX 12
+
+/* Partitions the elements of SIZE bytes each from FIRST up to
+   and including LAST, of which there are more than
+   INSERTION_SORT_MAX, around the median of the first, middle,
+   and last elements.  Returns the pivot's final position: every
+   element before it compares less than or equal to it and every
+   element after it greater than or equal. */
+static unsigned char *
+partition (unsigned char *first, unsigned char *last, size_t size,
+           int (*compare) (const void *, const void *, void *aux),
+           void *aux) 
+{
+  unsigned char *middle = first + ((last - first) / size / 2) * size;
+  unsigned char *i, *j;
+
+  /* Order the first, middle, and last elements, then move the
+     median to the front to serve as the pivot.  The last element
+     is then no less than the pivot, which stops the upward scan
+     below, and the pivot itself stops the downward one. */
+  if (compare (middle, first, aux) < 0)
+    do_swap (middle, first, size);
+  if (compare (last, middle, aux) < 0)
+    {
+      do_swap (last, middle, size);
+      if (compare (middle, first, aux) < 0)
+        do_swap (middle, first, size);
+    }
+  do_swap (first, middle, size);
+
+  /* Scan inward from both ends, stopping on elements equal to
+     the pivot so that runs of equal elements split evenly. */
+  i = first;
+  j = last + size;
+  for (;;)
+    {
+      do
+        i += size;
+      while (compare (i, first, aux) < 0);
+      do
+        j -= size;
+      while (compare (first, j, aux) < 0);
+      if (i >= j)
+        break;
+      do_swap (i, j, size);
+    }
+  do_swap (first, j, size);
+  return j;
+}
+
 /* Sorts ARRAY, which contains CNT elements of SIZE bytes each,
    using COMPARE to compare elements, passing AUX as auxiliary
    data.  When COMPARE is passed a pair of elements A and B,
    respectively, it must return a strcmp()-type result, i.e. less
    than zero if A < B, zero if A == B, greater than zero if A >
-   B.  Runs in O(n lg n) time and O(1) space in CNT. */
+   B.  Runs in O(n lg n) time and O(lg n) space in CNT.
+
+   This is an introsort: quicksort with median-of-three pivots,
+   switching to heapsort for any partition that is split badly
+   too many times and to insertion sort for small partitions. */
 void
 sort (void *array, size_t cnt, size_t size,
       int (*compare) (const void *, const void *, void *aux),
       void *aux) 
 {
-  size_t i;
+  struct
+    {
+      unsigned char *first, *last;
+      int depth;
+    }
+  stack[sizeof (size_t) * CHAR_BIT], *sp = stack;
+  unsigned char *first, *last;
+  int depth;
+  size_t n;
 
   ASSERT (array != NULL || cnt == 0);
   ASSERT (compare != NULL);
   ASSERT (size > 0);
 
-  /* Build a heap. */
-  for (i = cnt / 2; i > 0; i--)
-    heapify (array, i, cnt, size, compare, aux);
+  if (cnt < 2)
+    return;
 
-  /* Sort the heap. */
-  for (i = cnt; i > 1; i--) 
+  /* Allow about 2 lg CNT bad splits before giving up on
+     quicksort. */
+  depth = 0;
+  for (n = cnt; n > 1; n /= 2)
+    depth += 2;
+
+  first = array;
+  last = first + (cnt - 1) * size;
+  for (;;)
     {
-      do_swap (array, 1, i, size);
-      heapify (array, 1, i - 1, size, compare, aux); 
+      size_t part_cnt = (last - first) / size + 1;
+
+      if (part_cnt <= INSERTION_SORT_MAX)
+        insertion_sort (first, last, size, compare, aux);
+      else if (depth == 0)
+        heap_sort (first, part_cnt, size, compare, aux);
+      else
+        {
+          unsigned char *pivot = partition (first, last, size, compare, aux);
+
+          /* Defer the larger side and continue with the smaller,
+             so that the stack never holds more than lg CNT
+             partitions. */
+          depth--;
+          sp->depth = depth;
+          if (pivot - first > last - pivot)
+            {
+              sp->first = first;
+              sp->last = pivot - size;
+              first = pivot + size;
+            }
+          else
+            {
+              sp->first = pivot + size;
+              sp->last = last;
+              last = pivot - size;
+            }
+          sp++;
+          if (first < last)
+            continue;
+        }
+
+      /* Resume the most recently deferred partition. */
+      do
+        {
+          if (sp == stack)
+            return;
+          sp--;
+          first = sp->first;
+          last = sp->last;
+          depth = sp->depth;
+        }
+      while (first >= last);
     }
 }
 
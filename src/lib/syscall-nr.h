@@ -28,7 +28,19 @@ enum
     SYS_MKDIR,                  /* Create a directory. */
     SYS_READDIR,                /* Reads a directory entry. */
     SYS_ISDIR,                  /* Tests if a fd represents a directory. */
-    SYS_INUMBER                 /* Returns the inode number for a fd. */
+    SYS_INUMBER,                /* Returns the inode number for a fd. */
+
+    /* Extensions. */
+    SYS_READV,                  /* Read into several buffers. */
+    SYS_WRITEV,                 /* Write from several buffers. */
+    SYS_PREAD,                  /* Read at a given file offset. */
+    SYS_PWRITE,                 /* Write at a given file offset. */
+    SYS_RING_SETUP,             /* Map a system call submission ring. */
+    SYS_RING_ENTER,             /* Process queued ring requests. */
+    SYS_FUTEX_WAIT,             /* Sleep while a user int is unchanged. */
+    SYS_FUTEX_WAKE,             /* Wake threads sleeping on a user int. */
+    SYS_PIPE,                   /* Create a pipe. */
+    SYS_SHM_ATTACH              /* Map a shared memory page. */
   };
 
 #endif /* lib/syscall-nr.h */
@@ -0,0 +1,19 @@
+#ifndef __LIB_UIO_H
+#define __LIB_UIO_H
+
+/* Scatter/gather I/O vectors, shared by user programs and the
+   kernel for the readv() and writev() system calls. */
+
+#include <stddef.h>
+
+/* One buffer in a scatter/gather list. */
+struct iovec
+  {
+    void *iov_base;             /* Start of buffer. */
+    size_t iov_len;             /* Buffer length in bytes. */
+  };
+
+/* Maximum number of buffers in a single readv() or writev(). */
+#define IOV_MAX 32
+
+#endif /* lib/uio.h */
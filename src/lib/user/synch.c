@@ -0,0 +1,126 @@
+#include <synch.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <syscall.h>
+
+/* Atomically replaces *P by NEW if it equals OLD.  Returns the
+   previous value of *P. */
+static inline int
+atomic_cmpxchg (int *p, int old, int new)
+{
+  int prev;
+  asm volatile ("lock cmpxchgl %2, %1"
+                : "=a" (prev), "+m" (*p)
+                : "r" (new), "0" (old)
+                : "memory");
+  return prev;
+}
+
+/* Atomically stores NEW into *P and returns the previous
+   value. */
+static inline int
+atomic_xchg (int *p, int new)
+{
+  asm volatile ("xchgl %0, %1" : "+r" (new), "+m" (*p) : : "memory");
+  return new;
+}
+
+/* Atomically adds DELTA to *P and returns the previous value. */
+static inline int
+atomic_add (int *p, int delta)
+{
+  asm volatile ("lock xaddl %0, %1"
+                : "+r" (delta), "+m" (*p) : : "memory");
+  return delta;
+}
+
+/* Initializes MUTEX as unlocked. */
+void
+mutex_init (struct mutex *mutex)
+{
+  mutex->state = 0;
+}
+
+/* Acquires MUTEX, sleeping until it is available if necessary.
+   An uncontended acquire is a single atomic instruction. */
+void
+mutex_lock (struct mutex *mutex)
+{
+  int c = atomic_cmpxchg (&mutex->state, 0, 1);
+  if (c != 0)
+    {
+      /* Contended: mark the mutex as having waiters and sleep
+         until we are the one to take it. */
+      if (c != 2)
+        c = atomic_xchg (&mutex->state, 2);
+      while (c != 0)
+        {
+          futex_wait (&mutex->state, 2);
+          c = atomic_xchg (&mutex->state, 2);
+        }
+    }
+}
+
+/* Tries to acquire MUTEX without sleeping.  Returns true if
+   successful, false if MUTEX is held. */
+bool
+mutex_trylock (struct mutex *mutex)
+{
+  return atomic_cmpxchg (&mutex->state, 0, 1) == 0;
+}
+
+/* Releases MUTEX, which the caller must hold.  Enters the kernel
+   only if another thread may be waiting. */
+void
+mutex_unlock (struct mutex *mutex)
+{
+  if (atomic_add (&mutex->state, -1) != 1)
+    {
+      mutex->state = 0;
+      futex_wake (&mutex->state, 1);
+    }
+}
+
+/* Initializes condition variable COND. */
+void
+condvar_init (struct condvar *cond)
+{
+  cond->seq = 0;
+}
+
+/* Atomically releases MUTEX and waits for COND to be signaled,
+   then reacquires MUTEX.  As with kernel condition variables,
+   wakeups may be spurious, so the caller must recheck its
+   condition. */
+void
+condvar_wait (struct condvar *cond, struct mutex *mutex)
+{
+  int seq = cond->seq;
+
+  mutex_unlock (mutex);
+
+  /* A signal between the unlock and the wait changes SEQ, so
+     futex_wait() returns at once instead of missing it. */
+  futex_wait (&cond->seq, seq);
+
+  /* Other threads may have been woken with us, so take the
+     mutex in the contended state. */
+  while (atomic_xchg (&mutex->state, 2) != 0)
+    futex_wait (&mutex->state, 2);
+}
+
+/* Wakes one thread waiting on COND, if any. */
+void
+condvar_signal (struct condvar *cond)
+{
+  atomic_add (&cond->seq, 1);
+  futex_wake (&cond->seq, 1);
+}
+
+/* Wakes all threads waiting on COND. */
+void
+condvar_broadcast (struct condvar *cond)
+{
+  atomic_add (&cond->seq, 1);
+  futex_wake (&cond->seq, INT_MAX);
+}
@@ -3,6 +3,8 @@
 
 #include <stdbool.h>
 #include <debug.h>
+#include <ring.h>
+#include <uio.h>
 
 /* Process identifier. */
 typedef int pid_t;
@@ -45,4 +47,16 @@ bool readdir (int fd, char name[READDIR_MAX_LEN + 1]);
 bool isdir (int fd);
 int inumber (int fd);
 
+/* Extensions. */
+int readv (int fd, const struct iovec *iov, int iovcnt);
+int writev (int fd, const struct iovec *iov, int iovcnt);
+int pread (int fd, void *buffer, unsigned length, unsigned offset);
+int pwrite (int fd, const void *buffer, unsigned length, unsigned offset);
+bool ring_setup (struct sq_ring *ring);
+int ring_enter (unsigned to_submit);
+int futex_wait (int *addr, int val);
+int futex_wake (int *addr, int cnt);
+int pipe (int fds[2]);
+bool shm_attach (int key, void *addr);
+
 #endif /* lib/user/syscall.h */
@@ -0,0 +1,236 @@
+/* Test program for lib/kernel/hash.c.
+
+   Runs the same random mix of insertions, replacements,
+   deletions, and lookups against a chained table and an
+   open-addressed table, checking each against a plain array, and
+   checks that iteration visits every element exactly once, also
+   in the middle of an incremental rehash.  Then prints, for each
+   kind of table, the time taken by bulk insertions, lookups, and
+   deletions and the slowest single insertion.
+
+   This is not a test we will run on your submitted projects.
+   It is here for completeness.
+*/
+
+#undef NDEBUG
+#include <debug.h>
+#include <hash.h>
+#include <random.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/timer.h"
+#include "threads/test.h"
+
+/* Keys in the correctness test are drawn from 0...MAX_KEY - 1. */
+#define MAX_KEY 512
+
+/* Number of operations in the correctness test. */
+#define OP_CNT 20000
+
+/* Number of elements in the benchmark. */
+#define BENCH_CNT 20000
+
+/* A hash table element. */
+struct value
+  {
+    struct hash_elem elem;      /* Hash element. */
+    int key;                    /* Item key. */
+  };
+
+static bool (*const init_funcs[]) (struct hash *, hash_hash_func *,
+                                   hash_less_func *, void *) =
+  {hash_init, hash_init_open};
+static const char *const init_names[] = {"chained", "open"};
+
+static void test_table (int type);
+static void verify_table (struct hash *, struct value *present[]);
+static void bench (int type);
+
+static unsigned value_hash (const struct hash_elem *, void *);
+static bool value_less (const struct hash_elem *, const struct hash_elem *,
+                        void *);
+
+/* Test the hash table implementation. */
+void
+test (void)
+{
+  int type;
+
+  for (type = 0; type < 2; type++)
+    test_table (type);
+  printf ("hash: PASS\n");
+  for (type = 0; type < 2; type++)
+    bench (type);
+}
+
+/* Runs OP_CNT random operations on a table of the given TYPE,
+   checking each result against an array indexed by key. */
+static void
+test_table (int type)
+{
+  static struct value values[MAX_KEY * 2];
+  struct value *present[MAX_KEY];
+  struct hash h;
+  int i;
+
+  printf ("testing %s hash table...", init_names[type]);
+  ASSERT (init_funcs[type] (&h, value_hash, value_less, NULL));
+  memset (present, 0, sizeof present);
+
+  /* Each key has two elements, so that replacement can be told
+     apart from insertion. */
+  for (i = 0; i < MAX_KEY * 2; i++)
+    values[i].key = i % MAX_KEY;
+
+  for (i = 0; i < OP_CNT; i++)
+    {
+      /* Bias toward insertions for the first half of the run and
+         toward deletions for the second, so that the table both
+         grows and shrinks. */
+      int key = random_ulong () % MAX_KEY;
+      struct value *v = &values[key + (random_ulong () % 2) * MAX_KEY];
+      int op = random_ulong () % 8;
+      struct hash_elem *e;
+
+      if (i >= OP_CNT / 2)
+        op = 7 - op;
+      switch (op)
+        {
+        case 0: case 1: case 2:
+          if (present[key] != NULL)
+            v = present[key];
+          e = hash_insert (&h, &v->elem);
+          ASSERT (e == (present[key] != NULL ? &present[key]->elem : NULL));
+          present[key] = v;
+          break;
+
+        case 3:
+          if (present[key] == v)
+            v = &values[(v - values + MAX_KEY) % (MAX_KEY * 2)];
+          e = hash_replace (&h, &v->elem);
+          ASSERT (e == (present[key] != NULL ? &present[key]->elem : NULL));
+          present[key] = v;
+          break;
+
+        case 4:
+          e = hash_find (&h, &v->elem);
+          ASSERT (e == (present[key] != NULL ? &present[key]->elem : NULL));
+          break;
+
+        default:
+          e = hash_delete (&h, &v->elem);
+          ASSERT (e == (present[key] != NULL ? &present[key]->elem : NULL));
+          present[key] = NULL;
+          break;
+        }
+
+      if (i % 97 == 0)
+        verify_table (&h, present);
+    }
+  verify_table (&h, present);
+
+  hash_clear (&h, NULL);
+  ASSERT (hash_empty (&h));
+  memset (present, 0, sizeof present);
+  verify_table (&h, present);
+  hash_destroy (&h, NULL);
+  printf (" done\n");
+}
+
+/* Checks that iterating H visits exactly the elements in
+   PRESENT, and that H's size matches. */
+static void
+verify_table (struct hash *h, struct value *present[])
+{
+  static bool seen[MAX_KEY];
+  struct hash_iterator i;
+  size_t cnt = 0;
+  int key;
+
+  memset (seen, 0, sizeof seen);
+  hash_first (&i, h);
+  while (hash_next (&i))
+    {
+      struct value *v = hash_entry (hash_cur (&i), struct value, elem);
+      ASSERT (present[v->key] == v);
+      ASSERT (!seen[v->key]);
+      seen[v->key] = true;
+      cnt++;
+    }
+  ASSERT (hash_cur (&i) == NULL);
+
+  for (key = 0; key < MAX_KEY; key++)
+    ASSERT (seen[key] == (present[key] != NULL));
+  ASSERT (hash_size (h) == cnt);
+}
+
+/* Reads the processor's time stamp counter. */
+static inline uint64_t
+read_tsc (void)
+{
+  uint64_t tsc;
+  asm volatile ("rdtsc" : "=A" (tsc));
+  return tsc;
+}
+
+/* Times BENCH_CNT insertions, lookups, and deletions in a table
+   of the given TYPE, and finds the slowest single insertion. */
+static void
+bench (int type)
+{
+  static struct value values[BENCH_CNT];
+  uint64_t worst = 0;
+  int64_t insert_ticks, find_ticks, delete_ticks, start;
+  struct hash h;
+  int i;
+
+  for (i = 0; i < BENCH_CNT; i++)
+    values[i].key = random_ulong ();
+  ASSERT (init_funcs[type] (&h, value_hash, value_less, NULL));
+
+  start = timer_ticks ();
+  for (i = 0; i < BENCH_CNT; i++)
+    {
+      uint64_t tsc = read_tsc ();
+      hash_insert (&h, &values[i].elem);
+      tsc = read_tsc () - tsc;
+      if (tsc > worst)
+        worst = tsc;
+    }
+  insert_ticks = timer_elapsed (start);
+
+  start = timer_ticks ();
+  for (i = 0; i < BENCH_CNT; i++)
+    hash_find (&h, &values[i].elem);
+  find_ticks = timer_elapsed (start);
+
+  start = timer_ticks ();
+  for (i = 0; i < BENCH_CNT; i++)
+    hash_delete (&h, &values[i].elem);
+  delete_ticks = timer_elapsed (start);
+
+  hash_destroy (&h, NULL);
+  printf ("%-8s %d elements: insert %lld, find %lld, delete %lld ticks; "
+          "worst insert %llu cycles\n",
+          init_names[type], BENCH_CNT, insert_ticks, find_ticks,
+          delete_ticks, worst);
+}
+
+/* Returns a hash value for the value containing E. */
+static unsigned
+value_hash (const struct hash_elem *e, void *aux UNUSED)
+{
+  return hash_int (hash_entry (e, struct value, elem)->key);
+}
+
+/* Returns true if value A's key is less than value B's. */
+static bool
+value_less (const struct hash_elem *a_, const struct hash_elem *b_,
+            void *aux UNUSED)
+{
+  const struct value *a = hash_entry (a_, struct value, elem);
+  const struct value *b = hash_entry (b_, struct value, elem);
+
+  return a->key < b->key;
+}
@@ -0,0 +1,200 @@
+/* Test program for lib/kernel/heap.c.
+
+   Checks that elements come out of a heap in order, with equal
+   elements in insertion order, under a random mix of insertions,
+   pops, and removals.  Then compares the cost of inserting and
+   popping N elements, with N from 10 to 1000, against a list
+   kept in order with list_insert_ordered(), the way the run
+   queue and semaphore wait lists used to be kept.
+
+   This is not a test we will run on your submitted projects.
+   It is here for completeness.
+*/
+
+#undef NDEBUG
+#include <debug.h>
+#include <heap.h>
+#include <list.h>
+#include <random.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "threads/test.h"
+
+/* Maximum number of elements in a heap that we will test. */
+#define MAX_SIZE 1000
+
+/* Keys are drawn from 0...MAX_KEY - 1, so that many are equal,
+   as thread priorities usually are. */
+#define MAX_KEY 64
+
+/* A heap or list element. */
+struct value
+  {
+    struct heap_elem heap_elem; /* Heap element. */
+    struct list_elem list_elem; /* List element. */
+    int key;                    /* Item key. */
+    int order;                  /* Insertion order. */
+    bool in_heap;               /* In the heap? */
+  };
+
+static struct value values[MAX_SIZE];
+
+static void test_order (void);
+static void bench (int size);
+
+static bool heap_value_less (const struct heap_elem *,
+                             const struct heap_elem *, void *);
+static bool list_value_less (const struct list_elem *,
+                             const struct list_elem *, void *);
+
+/* Test the heap implementation. */
+void
+test (void)
+{
+  static const int sizes[] = {10, 30, 100, 300, 1000};
+  size_t i;
+
+  test_order ();
+  printf ("heap: PASS\n");
+  for (i = 0; i < sizeof sizes / sizeof *sizes; i++)
+    bench (sizes[i]);
+}
+
+/* Runs random operations on a heap, checking each popped
+   element against a linear search of VALUES for the least key
+   and, among equal keys, the earliest insertion. */
+static void
+test_order (void)
+{
+  struct heap heap;
+  size_t cnt = 0;
+  int order = 0;
+  int i;
+
+  printf ("testing heap order...");
+  heap_init (&heap, heap_value_less, NULL);
+  for (i = 0; i < MAX_SIZE; i++)
+    values[i].in_heap = false;
+
+  for (i = 0; i < 200000; i++)
+    {
+      struct value *v = &values[random_ulong () % MAX_SIZE];
+      int op = random_ulong () % 6;
+
+      if (op < 3)
+        {
+          if (!v->in_heap)
+            {
+              v->key = random_ulong () % MAX_KEY;
+              v->order = order++;
+              v->in_heap = true;
+              heap_insert (&heap, &v->heap_elem);
+              cnt++;
+            }
+        }
+      else if (op == 3)
+        {
+          if (v->in_heap)
+            {
+              heap_remove (&heap, &v->heap_elem);
+              v->in_heap = false;
+              cnt--;
+            }
+        }
+      else if (cnt > 0)
+        {
+          struct value *best = NULL;
+          struct value *top;
+          int j;
+
+          for (j = 0; j < MAX_SIZE; j++)
+            if (values[j].in_heap
+                && (best == NULL || values[j].key < best->key
+                    || (values[j].key == best->key
+                        && values[j].order < best->order)))
+              best = &values[j];
+
+          ASSERT (heap_top (&heap) == &best->heap_elem);
+          top = heap_entry (heap_pop (&heap), struct value, heap_elem);
+          ASSERT (top == best);
+          top->in_heap = false;
+          cnt--;
+        }
+
+      ASSERT (heap_size (&heap) == cnt);
+      ASSERT (heap_empty (&heap) == (cnt == 0));
+    }
+  printf (" done\n");
+}
+
+/* Reads the processor's time stamp counter. */
+static inline uint64_t
+read_tsc (void)
+{
+  uint64_t tsc;
+  asm volatile ("rdtsc" : "=A" (tsc));
+  return tsc;
+}
+
+/* Prints the average cycles per insertion and per pop for SIZE
+   random keys, for a heap and for an ordered list. */
+static void
+bench (int size)
+{
+  uint64_t heap_insert_cycles, heap_pop_cycles;
+  uint64_t list_insert_cycles, list_pop_cycles;
+  uint64_t start;
+  struct heap heap;
+  struct list list;
+  int i;
+
+  for (i = 0; i < size; i++)
+    values[i].key = random_ulong () % MAX_KEY;
+
+  heap_init (&heap, heap_value_less, NULL);
+  start = read_tsc ();
+  for (i = 0; i < size; i++)
+    heap_insert (&heap, &values[i].heap_elem);
+  heap_insert_cycles = read_tsc () - start;
+  start = read_tsc ();
+  for (i = 0; i < size; i++)
+    heap_pop (&heap);
+  heap_pop_cycles = read_tsc () - start;
+
+  list_init (&list);
+  start = read_tsc ();
+  for (i = 0; i < size; i++)
+    list_insert_ordered (&list, &values[i].list_elem, list_value_less, NULL);
+  list_insert_cycles = read_tsc () - start;
+  start = read_tsc ();
+  for (i = 0; i < size; i++)
+    list_pop_front (&list);
+  list_pop_cycles = read_tsc () - start;
+
+  printf ("%4d elements: heap insert %5llu pop %5llu, "
+          "list insert %5llu pop %5llu cycles each\n", size,
+          heap_insert_cycles / size, heap_pop_cycles / size,
+          list_insert_cycles / size, list_pop_cycles / size);
+}
+
+/* Returns true if value A's key is less than value B's. */
+static bool
+heap_value_less (const struct heap_elem *a_, const struct heap_elem *b_,
+                 void *aux UNUSED)
+{
+  const struct value *a = heap_entry (a_, struct value, heap_elem);
+  const struct value *b = heap_entry (b_, struct value, heap_elem);
+
+  return a->key < b->key;
+}
+
+/* Returns true if value A's key is less than value B's. */
+static bool
+list_value_less (const struct list_elem *a_, const struct list_elem *b_,
+                 void *aux UNUSED)
+{
+  const struct value *a = list_entry (a_, struct value, list_elem);
+  const struct value *b = list_entry (b_, struct value, list_elem);
+
+  return a->key < b->key;
+}
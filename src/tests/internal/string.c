@@ -0,0 +1,214 @@
+/* Test program for the block functions in lib/string.c.
+
+   Checks memcpy, memmove, and memset against simple byte-at-a-
+   time versions for every combination of source and destination
+   alignment and for a range of sizes, including overlapping
+   moves in both directions.  Then prints the throughput of each
+   function, and of the byte-at-a-time version, on a large
+   buffer.
+
+   This is not a test we will run on your submitted projects.
+   It is here for completeness.
+*/
+
+#undef NDEBUG
+#include <debug.h>
+#include <random.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/timer.h"
+#include "threads/test.h"
+
+/* Largest block checked for correctness. */
+#define MAX_SIZE 100
+
+/* Size of the blocks used for throughput, and number of times
+   each is processed. */
+#define BENCH_SIZE 65536
+#define BENCH_ROUNDS 64
+
+static void test_memcpy (void);
+static void test_memmove (void);
+static void test_memset (void);
+static void bench (void);
+
+static void fill_random (uint8_t *, size_t);
+static void byte_move (uint8_t *, const uint8_t *, size_t);
+static void byte_set (uint8_t *, int, size_t);
+
+/* Test memcpy(), memmove(), and memset(). */
+void
+test (void)
+{
+  test_memcpy ();
+  test_memmove ();
+  test_memset ();
+  printf ("string: PASS\n");
+  bench ();
+}
+
+/* Checks memcpy() at every alignment for every size up to
+   MAX_SIZE, including that bytes just outside the destination
+   are left alone. */
+static void
+test_memcpy (void)
+{
+  static uint8_t src[MAX_SIZE + 8], dst[MAX_SIZE + 16], ref[MAX_SIZE + 16];
+  size_t src_ofs, dst_ofs, size;
+
+  printf ("testing memcpy...");
+  for (src_ofs = 0; src_ofs < 4; src_ofs++)
+    for (dst_ofs = 0; dst_ofs < 4; dst_ofs++)
+      for (size = 0; size <= MAX_SIZE; size++)
+        {
+          fill_random (src, sizeof src);
+          fill_random (dst, sizeof dst);
+          memcpy (ref, dst, sizeof ref);
+
+          byte_move (ref + 4 + dst_ofs, src + src_ofs, size);
+          ASSERT (memcpy (dst + 4 + dst_ofs, src + src_ofs, size)
+                  == dst + 4 + dst_ofs);
+          ASSERT (!memcmp (dst, ref, sizeof dst));
+        }
+  printf (" done\n");
+}
+
+/* Checks memmove() for every pair of overlapping offsets within a
+   buffer, for every size up to MAX_SIZE. */
+static void
+test_memmove (void)
+{
+  static uint8_t buf[MAX_SIZE * 2 + 8], ref[MAX_SIZE * 2 + 8];
+  size_t src_ofs, dst_ofs, size;
+
+  printf ("testing memmove...");
+  for (src_ofs = 0; src_ofs < 8; src_ofs++)
+    for (dst_ofs = 0; dst_ofs < 8; dst_ofs++)
+      for (size = 0; size <= MAX_SIZE; size++)
+        {
+          fill_random (buf, sizeof buf);
+          memcpy (ref, buf, sizeof ref);
+
+          byte_move (ref + dst_ofs, ref + src_ofs, size);
+          ASSERT (memmove (buf + dst_ofs, buf + src_ofs, size)
+                  == buf + dst_ofs);
+          ASSERT (!memcmp (buf, ref, sizeof buf));
+        }
+  printf (" done\n");
+}
+
+/* Checks memset() at every alignment for every size up to
+   MAX_SIZE, with values whose high bits must be ignored. */
+static void
+test_memset (void)
+{
+  static uint8_t buf[MAX_SIZE + 16], ref[MAX_SIZE + 16];
+  size_t ofs, size;
+
+  printf ("testing memset...");
+  for (ofs = 0; ofs < 4; ofs++)
+    for (size = 0; size <= MAX_SIZE; size++)
+      {
+        int value = random_ulong ();
+
+        fill_random (buf, sizeof buf);
+        memcpy (ref, buf, sizeof ref);
+
+        byte_set (ref + 4 + ofs, value, size);
+        ASSERT (memset (buf + 4 + ofs, value, size) == buf + 4 + ofs);
+        ASSERT (!memcmp (buf, ref, sizeof buf));
+      }
+  printf (" done\n");
+}
+
+/* Prints the throughput of processing BENCH_ROUNDS blocks of
+   BENCH_SIZE bytes in ELAPSED timer ticks. */
+static void
+print_rate (const char *name, int64_t elapsed)
+{
+  long long kb = (long long) BENCH_SIZE * BENCH_ROUNDS / 1024;
+
+  if (elapsed == 0)
+    elapsed = 1;
+  printf ("%-12s %6lld kB in %3lld ticks: %8lld kB/s\n",
+          name, kb, elapsed, kb * TIMER_FREQ / elapsed);
+}
+
+/* Measures each function, and its byte-at-a-time equivalent, on
+   word-aligned blocks of BENCH_SIZE bytes. */
+static void
+bench (void)
+{
+  static uint8_t src[BENCH_SIZE], dst[BENCH_SIZE + 4];
+  int64_t start;
+  int i;
+
+  fill_random (src, sizeof src);
+
+  start = timer_ticks ();
+  for (i = 0; i < BENCH_ROUNDS; i++)
+    byte_move (dst, src, BENCH_SIZE);
+  print_rate ("byte copy", timer_elapsed (start));
+
+  start = timer_ticks ();
+  for (i = 0; i < BENCH_ROUNDS; i++)
+    memcpy (dst, src, BENCH_SIZE);
+  print_rate ("memcpy", timer_elapsed (start));
+
+  start = timer_ticks ();
+  for (i = 0; i < BENCH_ROUNDS; i++)
+    memcpy (dst + 1, src, BENCH_SIZE);
+  print_rate ("memcpy+1", timer_elapsed (start));
+
+  start = timer_ticks ();
+  for (i = 0; i < BENCH_ROUNDS; i++)
+    memmove (dst + 4, dst, BENCH_SIZE);
+  print_rate ("memmove up", timer_elapsed (start));
+
+  start = timer_ticks ();
+  for (i = 0; i < BENCH_ROUNDS; i++)
+    byte_set (dst, i, BENCH_SIZE);
+  print_rate ("byte fill", timer_elapsed (start));
+
+  start = timer_ticks ();
+  for (i = 0; i < BENCH_ROUNDS; i++)
+    memset (dst, i, BENCH_SIZE);
+  print_rate ("memset", timer_elapsed (start));
+}
+
+/* Fills the SIZE bytes at BUF with random data. */
+static void
+fill_random (uint8_t *buf, size_t size)
+{
+  random_bytes (buf, size);
+}
+
+/* Reference memmove(): copies SIZE bytes from SRC to DST one
+   byte at a time, in whichever direction overlap requires.  The
+   stores are volatile so that the compiler can't turn the loop
+   back into a call to memmove(). */
+static void
+byte_move (uint8_t *dst, const uint8_t *src, size_t size)
+{
+  volatile uint8_t *d = dst;
+
+  if (dst < src)
+    while (size-- > 0)
+      *d++ = *src++;
+  else
+    while (size-- > 0)
+      d[size] = src[size];
+}
+
+/* Reference memset(): stores VALUE into the SIZE bytes at DST
+   one byte at a time, through a volatile pointer like
+   byte_move(). */
+static void
+byte_set (uint8_t *dst, int value, size_t size)
+{
+  volatile uint8_t *d = dst;
+
+  while (size-- > 0)
+    *d++ = value;
+}
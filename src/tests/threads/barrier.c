@@ -0,0 +1,72 @@
+/* Runs several threads through a barrier for a few rounds,
+   checking that no thread leaves a round before every thread
+   has arrived and that exactly one thread is told it was last
+   in each round. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+#define THREAD_CNT 5
+#define ROUND_CNT 3
+
+static thread_func barrier_thread;
+static struct barrier barrier;
+static struct lock lock;
+static struct semaphore done;
+static int arrived[ROUND_CNT];  /* Threads that reached each round. */
+static int last[ROUND_CNT];     /* Threads told they were last. */
+
+void
+test_barrier (void) 
+{
+  int i;
+
+  barrier_init (&barrier, THREAD_CNT);
+  lock_init (&lock);
+  sema_init (&done, 0);
+
+  for (i = 0; i < THREAD_CNT; i++) 
+    {
+      char name[16];
+      snprintf (name, sizeof name, "barrier %d", i);
+      thread_create (name, PRI_DEFAULT, barrier_thread, NULL);
+    }
+  for (i = 0; i < THREAD_CNT; i++)
+    sema_down (&done);
+
+  for (i = 0; i < ROUND_CNT; i++)
+    if (last[i] != 1)
+      fail ("%d threads were last in round %d.", last[i], i);
+  msg ("%d threads passed %d rounds.", THREAD_CNT, ROUND_CNT);
+  msg ("1 thread was last in each round.");
+}
+
+static void
+barrier_thread (void *aux UNUSED) 
+{
+  int round;
+
+  for (round = 0; round < ROUND_CNT; round++)
+    {
+      bool was_last;
+
+      lock_acquire (&lock);
+      arrived[round]++;
+      lock_release (&lock);
+      thread_yield ();
+
+      was_last = barrier_wait (&barrier);
+
+      lock_acquire (&lock);
+      if (arrived[round] != THREAD_CNT)
+        fail ("Thread %s left round %d after only %d threads arrived.",
+              thread_name (), round, arrived[round]);
+      if (was_last)
+        last[round]++;
+      lock_release (&lock);
+    }
+  sema_up (&done);
+}
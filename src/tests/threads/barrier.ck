@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(barrier) begin
+(barrier) 5 threads passed 3 rounds.
+(barrier) 1 thread was last in each round.
+(barrier) end
+EOF
+pass;
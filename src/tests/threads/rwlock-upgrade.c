@@ -0,0 +1,67 @@
+/* Checks that an upgradeable reader shares a readers-writer lock
+   with ordinary readers, and that when it upgrades it gets the
+   write lock as soon as they leave, ahead of a writer that was
+   already waiting. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+static thread_func reader_thread;
+static thread_func writer_thread;
+static struct rwlock rwlock;
+static struct semaphore go;
+static struct semaphore done;
+
+void
+test_rwlock_upgrade (void) 
+{
+  rwlock_init (&rwlock);
+  sema_init (&go, 0);
+  sema_init (&done, 0);
+
+  rwlock_acquire_upgradeable (&rwlock);
+  msg ("Main thread holds upgradeable lock.");
+
+  /* An ordinary reader gets in alongside us and stays until we
+     let it go. */
+  thread_create ("reader", PRI_DEFAULT, reader_thread, NULL);
+  timer_sleep (10);
+
+  /* A writer has to wait for both of us. */
+  thread_create ("writer", PRI_DEFAULT, writer_thread, NULL);
+  timer_sleep (10);
+
+  msg ("Main thread upgrading.");
+  sema_up (&go);
+  rwlock_upgrade (&rwlock);
+  msg ("Main thread upgraded to write lock.");
+  rwlock_release_write (&rwlock);
+
+  sema_down (&done);
+  sema_down (&done);
+  msg ("Reader and writer finished.");
+}
+
+static void
+reader_thread (void *aux UNUSED) 
+{
+  rwlock_acquire_read (&rwlock);
+  msg ("Thread %s acquired read lock.", thread_name ());
+  sema_down (&go);
+  msg ("Thread %s releasing read lock.", thread_name ());
+  rwlock_release_read (&rwlock);
+  sema_up (&done);
+}
+
+static void
+writer_thread (void *aux UNUSED) 
+{
+  rwlock_acquire_write (&rwlock);
+  msg ("Thread %s acquired write lock.", thread_name ());
+  rwlock_release_write (&rwlock);
+  sema_up (&done);
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rwlock-upgrade) begin
+(rwlock-upgrade) Main thread holds upgradeable lock.
+(rwlock-upgrade) Thread reader acquired read lock.
+(rwlock-upgrade) Main thread upgrading.
+(rwlock-upgrade) Thread reader releasing read lock.
+(rwlock-upgrade) Main thread upgraded to write lock.
+(rwlock-upgrade) Thread writer acquired write lock.
+(rwlock-upgrade) Reader and writer finished.
+(rwlock-upgrade) end
+EOF
+pass;
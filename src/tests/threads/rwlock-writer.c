@@ -0,0 +1,61 @@
+/* Checks that readers share a readers-writer lock and that a
+   waiting writer is preferred over readers that arrive after
+   it. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+static thread_func reader_thread;
+static thread_func writer_thread;
+static struct rwlock rwlock;
+static struct semaphore done;
+
+void
+test_rwlock_writer (void) 
+{
+  rwlock_init (&rwlock);
+  sema_init (&done, 0);
+
+  rwlock_acquire_read (&rwlock);
+  msg ("Main thread holds read lock.");
+
+  /* A second reader gets in alongside us. */
+  thread_create ("reader 1", PRI_DEFAULT, reader_thread, NULL);
+  sema_down (&done);
+
+  /* A writer has to wait for us... */
+  thread_create ("writer", PRI_DEFAULT, writer_thread, NULL);
+  timer_sleep (10);
+
+  /* ...and a reader that comes after it has to wait for it. */
+  thread_create ("reader 2", PRI_DEFAULT, reader_thread, NULL);
+  timer_sleep (10);
+
+  msg ("Main thread releasing read lock.");
+  rwlock_release_read (&rwlock);
+  sema_down (&done);
+  sema_down (&done);
+  msg ("Writer and reader finished.");
+}
+
+static void
+reader_thread (void *aux UNUSED) 
+{
+  rwlock_acquire_read (&rwlock);
+  msg ("Thread %s acquired read lock.", thread_name ());
+  rwlock_release_read (&rwlock);
+  sema_up (&done);
+}
+
+static void
+writer_thread (void *aux UNUSED) 
+{
+  rwlock_acquire_write (&rwlock);
+  msg ("Thread %s acquired write lock.", thread_name ());
+  rwlock_release_write (&rwlock);
+  sema_up (&done);
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rwlock-writer) begin
+(rwlock-writer) Main thread holds read lock.
+(rwlock-writer) Thread reader 1 acquired read lock.
+(rwlock-writer) Main thread releasing read lock.
+(rwlock-writer) Thread writer acquired write lock.
+(rwlock-writer) Thread reader 2 acquired read lock.
+(rwlock-writer) Writer and reader finished.
+(rwlock-writer) end
+EOF
+pass;
@@ -0,0 +1,32 @@
+/* Child process run by futex-shared test.
+   Attaches the parent's shared page, checks that the parent's
+   store is visible in it, and sleeps in futex_wait() until the
+   parent wakes it.  Records its result in the shared page. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+
+const char *test_name = "child-futex";
+
+/* Shared page key and address, as in futex-shared. */
+#define SHM_KEY 36
+static int *const shared = (int *) 0x10000000;
+
+int
+main (void) 
+{
+  if (!shm_attach (SHM_KEY, shared))
+    fail ("shm_attach failed");
+  if (shared[1] != 1234)
+    {
+      shared[2] = -1;
+      fail ("parent's store not seen in shared page");
+    }
+  if (futex_wait (&shared[0], 0) != 0)
+    {
+      shared[2] = -1;
+      fail ("futex_wait() returned without sleeping");
+    }
+  shared[2] = 5678;
+  return 81;
+}
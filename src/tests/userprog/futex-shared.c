@@ -0,0 +1,35 @@
+/* Has a child process sleep in futex_wait() on a futex in a page
+   that both processes attach with shm_attach(), and wakes it
+   once futex_wake() finds it asleep.  The child must block until
+   then, and stores through the shared page must be seen by both
+   processes. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Shared page key and address, also used by child-futex. */
+#define SHM_KEY 36
+static int *const shared = (int *) 0x10000000;
+
+void
+test_main (void) 
+{
+  pid_t child;
+  int woken, exit_code;
+
+  CHECK (shm_attach (SHM_KEY, shared), "shm_attach");
+  shared[1] = 1234;
+  CHECK ((child = exec ("child-futex")) != -1, "exec \"child-futex\"");
+
+  /* futex_wake() finds the child only once it is asleep.  Give
+     up if it sets shared[2], its result, without sleeping. */
+  while ((woken = futex_wake (&shared[0], 1)) == 0)
+    if (shared[2] != 0)
+      break;
+  exit_code = wait (child);
+
+  CHECK (woken == 1, "futex_wake() woke sleeping child");
+  CHECK (exit_code == 81, "child returned from futex_wait()");
+  CHECK (shared[2] == 5678, "child's store seen in shared page");
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(futex-shared) begin
+(futex-shared) shm_attach
+(futex-shared) exec "child-futex"
+child-futex: exit(81)
+(futex-shared) futex_wake() woke sleeping child
+(futex-shared) child returned from futex_wait()
+(futex-shared) child's store seen in shared page
+(futex-shared) end
+futex-shared: exit(0)
+EOF
+pass;
@@ -0,0 +1,36 @@
+/* Exercises futex_wait() and futex_wake() without contention,
+   along with the user-level mutex and condition variable built
+   on them.  A process has only one thread, so nothing could ever
+   wake a futex_wait() on its private memory whose value matches;
+   it must fail at once rather than hang. */
+
+#include <synch.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  static struct mutex mutex = MUTEX_INITIALIZER;
+  static struct condvar cond = CONDVAR_INITIALIZER;
+  int word[2] = {5, 0};
+
+  CHECK (futex_wait (&word[0], 4) == -1,
+         "futex_wait() on changed value returns at once");
+  CHECK (futex_wake (&word[0], 1) == 0, "futex_wake() with no waiters");
+  CHECK (futex_wake ((int *) ((char *) word + 1), 1) == -1,
+         "futex_wake() on misaligned address");
+  CHECK (futex_wait (&word[0], 5) == -1,
+         "futex_wait() with no possible waker returns at once");
+
+  mutex_lock (&mutex);
+  CHECK (!mutex_trylock (&mutex), "mutex_trylock() on held mutex fails");
+  condvar_wait (&cond, &mutex);
+  CHECK (!mutex_trylock (&mutex), "condvar_wait() returns holding mutex");
+  condvar_signal (&cond);
+  condvar_broadcast (&cond);
+  mutex_unlock (&mutex);
+  CHECK (mutex_trylock (&mutex), "mutex_trylock() on free mutex");
+  mutex_unlock (&mutex);
+}
@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(futex-simple) begin
+(futex-simple) futex_wait() on changed value returns at once
+(futex-simple) futex_wake() with no waiters
+(futex-simple) futex_wake() on misaligned address
+(futex-simple) futex_wait() with no possible waker returns at once
+(futex-simple) mutex_trylock() on held mutex fails
+(futex-simple) condvar_wait() returns holding mutex
+(futex-simple) mutex_trylock() on free mutex
+(futex-simple) end
+futex-simple: exit(0)
+EOF
+pass;
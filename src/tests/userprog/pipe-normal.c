@@ -0,0 +1,55 @@
+/* Sends data through a pipe, including two whole pages read into
+   a page-aligned buffer, then checks end of file after the write
+   end is closed and that writing fails once the read end is
+   closed. */
+
+#include <random.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+
+static char data[2 * PAGE_SIZE];
+static char buf[2 * PAGE_SIZE] __attribute__ ((aligned (PAGE_SIZE)));
+
+void
+test_main (void) 
+{
+  int fds[2];
+  char byte;
+
+  CHECK (pipe (fds) == 0, "pipe");
+
+  random_init (0);
+  random_bytes (data, sizeof data);
+  CHECK (write (fds[1], data, 10) == 10, "write 10 bytes");
+  CHECK (read (fds[0], buf, sizeof buf) == 10, "read 10 bytes");
+  compare_bytes (buf, data, 10, 0, "pipe");
+
+  CHECK (write (fds[1], data, sizeof data) == sizeof data,
+         "write 2 pages");
+  CHECK (read (fds[0], buf, sizeof buf) == sizeof data, "read 2 pages");
+  compare_bytes (buf, data, sizeof data, 0, "pipe");
+
+  /* The data now starts 10 bytes into a pipe page.  Read up to
+     the next page boundary, then a whole page into a
+     page-aligned buffer. */
+  CHECK (write (fds[1], data, sizeof data) == sizeof data,
+         "write 2 pages again");
+  CHECK (read (fds[0], buf, PAGE_SIZE - 10) == PAGE_SIZE - 10,
+         "read to end of pipe page");
+  compare_bytes (buf, data, PAGE_SIZE - 10, 0, "pipe");
+  CHECK (read (fds[0], buf, PAGE_SIZE) == PAGE_SIZE,
+         "read whole page into aligned buffer");
+  compare_bytes (buf, data + PAGE_SIZE - 10, PAGE_SIZE, 0, "pipe");
+
+  close (fds[1]);
+  CHECK (read (fds[0], buf, sizeof buf) == 10, "read last 10 bytes");
+  compare_bytes (buf, data + 2 * PAGE_SIZE - 10, 10, 0, "pipe");
+  CHECK (read (fds[0], &byte, 1) == 0, "read at end of file");
+
+  CHECK (pipe (fds) == 0, "pipe");
+  close (fds[0]);
+  CHECK (write (fds[1], data, 1) == -1, "write with no reader");
+}
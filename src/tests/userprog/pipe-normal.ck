@@ -0,0 +1,22 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pipe-normal) begin
+(pipe-normal) pipe
+(pipe-normal) write 10 bytes
+(pipe-normal) read 10 bytes
+(pipe-normal) write 2 pages
+(pipe-normal) read 2 pages
+(pipe-normal) write 2 pages again
+(pipe-normal) read to end of pipe page
+(pipe-normal) read whole page into aligned buffer
+(pipe-normal) read last 10 bytes
+(pipe-normal) read at end of file
+(pipe-normal) pipe
+(pipe-normal) write with no reader
+(pipe-normal) end
+pipe-normal: exit(0)
+EOF
+pass;
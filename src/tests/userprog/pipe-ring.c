@@ -0,0 +1,43 @@
+/* Reads a whole page from a pipe into the system call ring's
+   page, closes the pipe, and then checks that the kernel and the
+   process still share the ring.  The read must copy into the
+   ring page rather than trade it for one of the pipe's pages,
+   which the kernel would otherwise go on using after the pipe
+   frees them. */
+
+#include <ring.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+
+/* Page-aligned address at which to map the ring. */
+static struct sq_ring *const ring = (struct sq_ring *) 0x10000000;
+
+/* A page of zeros is an empty ring. */
+static char zeros[PAGE_SIZE];
+
+void
+test_main (void) 
+{
+  struct sq_entry *sqe;
+  int fds[2];
+
+  CHECK (ring_setup (ring), "ring_setup");
+  CHECK (pipe (fds) == 0, "pipe");
+  CHECK (write (fds[1], zeros, PAGE_SIZE) == PAGE_SIZE, "write 1 page");
+  CHECK (read (fds[0], ring, PAGE_SIZE) == PAGE_SIZE,
+         "read 1 page into ring");
+  close (fds[0]);
+  close (fds[1]);
+
+  sqe = &ring->sqes[ring->sq_tail % RING_ENTRIES];
+  sqe->opcode = RING_OP_NOP;
+  sqe->user_data = 42;
+  ring->sq_tail++;
+  CHECK (ring_enter (1) == 1, "ring_enter");
+  CHECK (ring->sq_head == 1, "request consumed");
+  CHECK (ring->cq_tail == 1 && ring->cqes[0].user_data == 42
+         && ring->cqes[0].res == 0, "completion posted");
+}
@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pipe-ring) begin
+(pipe-ring) ring_setup
+(pipe-ring) pipe
+(pipe-ring) write 1 page
+(pipe-ring) read 1 page into ring
+(pipe-ring) ring_enter
+(pipe-ring) request consumed
+(pipe-ring) completion posted
+(pipe-ring) end
+pipe-ring: exit(0)
+EOF
+pass;
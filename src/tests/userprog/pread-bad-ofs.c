@@ -0,0 +1,26 @@
+/* Calls pread() and pwrite() with offsets that are negative when
+   taken as ints, which must fail with -1, and pread() at and past
+   end of file, which must return 0. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char buf[16];
+  int handle;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (pread (handle, buf, sizeof buf, -1) == -1,
+         "pread() at offset -1 fails");
+  CHECK (pwrite (handle, buf, sizeof buf, -1) == -1,
+         "pwrite() at offset -1 fails");
+  CHECK (pread (handle, buf, sizeof buf, sizeof sample - 1) == 0,
+         "pread() at end of file reads nothing");
+  CHECK (pread (handle, buf, sizeof buf, 1000000) == 0,
+         "pread() past end of file reads nothing");
+  check_file ("sample.txt", sample, sizeof sample - 1);
+}
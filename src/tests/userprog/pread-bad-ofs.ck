@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pread-bad-ofs) begin
+(pread-bad-ofs) open "sample.txt"
+(pread-bad-ofs) pread() at offset -1 fails
+(pread-bad-ofs) pwrite() at offset -1 fails
+(pread-bad-ofs) pread() at end of file reads nothing
+(pread-bad-ofs) pread() past end of file reads nothing
+(pread-bad-ofs) open "sample.txt" for verification
+(pread-bad-ofs) verified contents of "sample.txt"
+(pread-bad-ofs) close "sample.txt"
+(pread-bad-ofs) end
+pread-bad-ofs: exit(0)
+EOF
+pass;
@@ -0,0 +1,31 @@
+/* Read the two halves of a file with pread(), back half first,
+   and check that the data is correct and that the file position
+   does not move. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  size_t size = sizeof sample - 1;
+  size_t half = size / 2;
+  char buffer[sizeof sample];
+  int handle, byte_cnt;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+
+  byte_cnt = pread (handle, buffer + half, size - half, half);
+  if (byte_cnt != (int) (size - half))
+    fail ("pread() returned %d instead of %zu", byte_cnt, size - half);
+  byte_cnt = pread (handle, buffer, half, 0);
+  if (byte_cnt != (int) half)
+    fail ("pread() returned %d instead of %zu", byte_cnt, half);
+  compare_bytes (buffer, sample, size, 0, "sample.txt");
+
+  if (tell (handle) != 0)
+    fail ("file position moved to %u", tell (handle));
+  msg ("verified contents of \"sample.txt\"");
+}
@@ -0,0 +1,31 @@
+/* Write the two halves of a file with pwrite(), back half first,
+   and check that the file position does not move and that the
+   file's contents are correct. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  size_t size = sizeof sample - 1;
+  size_t half = size / 2;
+  int handle, byte_cnt;
+
+  CHECK (create ("test.txt", size), "create \"test.txt\"");
+  CHECK ((handle = open ("test.txt")) > 1, "open \"test.txt\"");
+
+  byte_cnt = pwrite (handle, sample + half, size - half, half);
+  if (byte_cnt != (int) (size - half))
+    fail ("pwrite() returned %d instead of %zu", byte_cnt, size - half);
+  byte_cnt = pwrite (handle, sample, half, 0);
+  if (byte_cnt != (int) half)
+    fail ("pwrite() returned %d instead of %zu", byte_cnt, half);
+  if (tell (handle) != 0)
+    fail ("file position moved to %u", tell (handle));
+  close (handle);
+
+  check_file ("test.txt", sample, size);
+}
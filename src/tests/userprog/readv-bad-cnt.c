@@ -0,0 +1,30 @@
+/* Calls readv() with more buffers than IOV_MAX and with a
+   negative buffer count.  Each call must fail with -1 without
+   reading anything. */
+
+#include <syscall.h>
+#include <uio.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  static struct iovec iov[IOV_MAX + 1];
+  static char buf[IOV_MAX + 1];
+  int handle;
+  int i;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  for (i = 0; i < IOV_MAX + 1; i++)
+    {
+      iov[i].iov_base = &buf[i];
+      iov[i].iov_len = 1;
+    }
+
+  CHECK (readv (handle, iov, IOV_MAX + 1) == -1,
+         "readv() with IOV_MAX + 1 buffers fails");
+  CHECK (readv (handle, iov, -1) == -1,
+         "readv() with -1 buffers fails");
+  CHECK (tell (handle) == 0, "file position unchanged");
+}
@@ -0,0 +1,39 @@
+/* Read a file with a single readv() call that scatters the data
+   into several buffers, including an empty one, then check the
+   data and that a further readv() at end of file returns 0. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  size_t size = sizeof sample - 1;
+  char head[16], tail[sizeof sample];
+  struct iovec iov[3];
+  int handle, byte_cnt;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+
+  iov[0].iov_base = head;
+  iov[0].iov_len = sizeof head;
+  iov[1].iov_base = tail;
+  iov[1].iov_len = 0;
+  iov[2].iov_base = tail;
+  iov[2].iov_len = sizeof tail;
+  byte_cnt = readv (handle, iov, 3);
+  if (byte_cnt != (int) size)
+    fail ("readv() returned %d instead of %zu", byte_cnt, size);
+  compare_bytes (head, sample, sizeof head, 0, "sample.txt");
+  compare_bytes (tail, sample + sizeof head, size - sizeof head,
+                 sizeof head, "sample.txt");
+  msg ("verified contents of \"sample.txt\"");
+
+  byte_cnt = readv (handle, iov, 3);
+  if (byte_cnt != 0)
+    fail ("readv() at end of file returned %d instead of 0", byte_cnt);
+  msg ("readv() at end of file");
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(readv-normal) begin
+(readv-normal) open "sample.txt"
+(readv-normal) verified contents of "sample.txt"
+(readv-normal) readv() at end of file
+(readv-normal) end
+readv-normal: exit(0)
+EOF
+pass;
@@ -0,0 +1,28 @@
+/* Submits a WRITE request through the system call ring whose
+   buffer is a kernel address.  The process must be terminated
+   with -1 exit code, just as for the write system call. */
+
+#include <ring.h>
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Page-aligned address at which to map the ring. */
+static struct sq_ring *const ring = (struct sq_ring *) 0x10000000;
+
+void
+test_main (void) 
+{
+  struct sq_entry *sqe;
+
+  CHECK (ring_setup (ring), "ring_setup");
+  sqe = &ring->sqes[ring->sq_tail % RING_ENTRIES];
+  sqe->opcode = RING_OP_WRITE;
+  sqe->fd = STDOUT_FILENO;
+  sqe->addr = 0xc0100000;
+  sqe->len = 123;
+  ring->sq_tail++;
+  ring_enter (1);
+  fail ("should not have survived ring_enter()");
+}
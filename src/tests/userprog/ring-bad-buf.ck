@@ -0,0 +1,10 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(ring-bad-buf) begin
+(ring-bad-buf) ring_setup
+ring-bad-buf: exit(-1)
+EOF
+pass;
@@ -0,0 +1,13 @@
+/* Calls ring_enter() without first setting up a system call
+   ring.  It must fail with -1 and the process must go on
+   running. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  CHECK (ring_enter (1) == -1, "ring_enter without ring_setup");
+}
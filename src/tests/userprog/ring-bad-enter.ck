@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(ring-bad-enter) begin
+(ring-bad-enter) ring_enter without ring_setup
+(ring-bad-enter) end
+ring-bad-enter: exit(0)
+EOF
+pass;
@@ -0,0 +1,47 @@
+/* Fills the system call ring's completion queue, then submits
+   one more request.  ring_enter() must leave it queued until a
+   completion is reaped, rather than overwrite one that has not
+   been. */
+
+#include <ring.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Page-aligned address at which to map the ring. */
+static struct sq_ring *const ring = (struct sq_ring *) 0x10000000;
+
+/* Queues a NOP request carrying USER_DATA in the ring. */
+static void
+queue_nop (uint32_t user_data)
+{
+  struct sq_entry *sqe = &ring->sqes[ring->sq_tail % RING_ENTRIES];
+
+  sqe->opcode = RING_OP_NOP;
+  sqe->user_data = user_data;
+  ring->sq_tail++;
+}
+
+void
+test_main (void) 
+{
+  unsigned i;
+
+  CHECK (ring_setup (ring), "ring_setup");
+  for (i = 0; i < RING_ENTRIES; i++)
+    queue_nop (i);
+  CHECK (ring_enter (RING_ENTRIES) == RING_ENTRIES,
+         "ring_enter fills completion queue");
+
+  queue_nop (RING_ENTRIES);
+  CHECK (ring_enter (1) == 0, "ring_enter with full completion queue");
+  CHECK (ring->sq_head == RING_ENTRIES, "request left queued");
+  CHECK (ring->cq_tail == RING_ENTRIES && ring->cqes[0].user_data == 0,
+         "completions intact");
+
+  ring->cq_head++;
+  CHECK (ring_enter (1) == 1, "ring_enter after reaping one completion");
+  CHECK (ring->cq_tail == RING_ENTRIES + 1
+         && ring->cqes[0].user_data == RING_ENTRIES,
+         "completion posted");
+}
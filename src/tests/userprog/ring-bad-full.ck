@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(ring-bad-full) begin
+(ring-bad-full) ring_setup
+(ring-bad-full) ring_enter fills completion queue
+(ring-bad-full) ring_enter with full completion queue
+(ring-bad-full) request left queued
+(ring-bad-full) completions intact
+(ring-bad-full) ring_enter after reaping one completion
+(ring-bad-full) completion posted
+(ring-bad-full) end
+ring-bad-full: exit(0)
+EOF
+pass;
@@ -0,0 +1,27 @@
+/* Submits a request with an unknown opcode through the system
+   call ring.  The request must be consumed and completed with
+   result -1, and the process must go on running. */
+
+#include <ring.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Page-aligned address at which to map the ring. */
+static struct sq_ring *const ring = (struct sq_ring *) 0x10000000;
+
+void
+test_main (void) 
+{
+  struct sq_entry *sqe;
+
+  CHECK (ring_setup (ring), "ring_setup");
+  sqe = &ring->sqes[ring->sq_tail % RING_ENTRIES];
+  sqe->opcode = 0x12345678;
+  sqe->user_data = 42;
+  ring->sq_tail++;
+  CHECK (ring_enter (1) == 1, "ring_enter");
+  CHECK (ring->sq_head == 1, "request consumed");
+  CHECK (ring->cq_tail == 1 && ring->cqes[0].user_data == 42
+         && ring->cqes[0].res == -1, "completion posted with -1");
+}
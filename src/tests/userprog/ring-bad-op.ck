@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(ring-bad-op) begin
+(ring-bad-op) ring_setup
+(ring-bad-op) ring_enter
+(ring-bad-op) request consumed
+(ring-bad-op) completion posted with -1
+(ring-bad-op) end
+ring-bad-op: exit(0)
+EOF
+pass;
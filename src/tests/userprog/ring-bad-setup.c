@@ -0,0 +1,31 @@
+/* Passes ring_setup() addresses at which no ring may be mapped:
+   null, unaligned, already mapped, and within the range reserved
+   for the stack.  Each must fail, without keeping a later
+   ring_setup() at a good address from succeeding, which in turn
+   must be the only one. */
+
+#include <ring.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* A page-aligned buffer in the program's data. */
+static char data_page[4096] __attribute__ ((aligned (4096)));
+
+void
+test_main (void) 
+{
+  /* Touch the buffer so that its page is surely mapped. */
+  data_page[0] = 1;
+
+  CHECK (!ring_setup (NULL), "ring_setup at null");
+  CHECK (!ring_setup ((struct sq_ring *) 0x10000010),
+         "ring_setup at unaligned address");
+  CHECK (!ring_setup ((struct sq_ring *) data_page),
+         "ring_setup at mapped address");
+  CHECK (!ring_setup ((struct sq_ring *) 0xbfff0000),
+         "ring_setup in stack range");
+  CHECK (ring_setup ((struct sq_ring *) 0x10000000), "ring_setup");
+  CHECK (!ring_setup ((struct sq_ring *) 0x10001000),
+         "second ring_setup");
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(ring-bad-setup) begin
+(ring-bad-setup) ring_setup at null
+(ring-bad-setup) ring_setup at unaligned address
+(ring-bad-setup) ring_setup at mapped address
+(ring-bad-setup) ring_setup in stack range
+(ring-bad-setup) ring_setup
+(ring-bad-setup) second ring_setup
+(ring-bad-setup) end
+ring-bad-setup: exit(0)
+EOF
+pass;
@@ -0,0 +1,91 @@
+/* Carries out one request of each kind through the system call
+   ring, checking the result in each completion: NOP, OPEN and
+   READ/PREAD on "sample.txt", WRITE/PWRITE on a new file, then
+   CLOSE on both. */
+
+#include <ring.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Page-aligned address at which to map the ring. */
+static struct sq_ring *const ring = (struct sq_ring *) 0x10000000;
+
+/* Queues a request with the given fields in the ring. */
+static void
+queue (enum ring_op opcode, int fd, const void *addr, size_t len,
+       unsigned offset, uint32_t user_data)
+{
+  struct sq_entry *sqe = &ring->sqes[ring->sq_tail % RING_ENTRIES];
+
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->addr = (uint32_t) addr;
+  sqe->len = len;
+  sqe->offset = offset;
+  sqe->user_data = user_data;
+  ring->sq_tail++;
+}
+
+/* Reaps the next completion from the ring, which must be for the
+   request queued with USER_DATA, and returns its result. */
+static int
+reap (uint32_t user_data)
+{
+  struct cq_entry *cqe;
+
+  if (ring->cq_head == ring->cq_tail)
+    fail ("no completion for request %u", user_data);
+  cqe = &ring->cqes[ring->cq_head % RING_ENTRIES];
+  if (cqe->user_data != user_data)
+    fail ("completion for request %u instead of %u",
+          cqe->user_data, user_data);
+  ring->cq_head++;
+  return cqe->res;
+}
+
+void
+test_main (void) 
+{
+  size_t size = sizeof sample - 1;
+  size_t half = size / 2;
+  char buf[sizeof sample];
+  int sample_fd, test_fd;
+
+  CHECK (ring_setup (ring), "ring_setup");
+  CHECK (create ("test.txt", size), "create \"test.txt\"");
+
+  queue (RING_OP_NOP, 0, NULL, 0, 0, 1);
+  queue (RING_OP_OPEN, 0, "sample.txt", 0, 0, 2);
+  queue (RING_OP_OPEN, 0, "test.txt", 0, 0, 3);
+  CHECK (ring_enter (3) == 3, "ring_enter NOP, OPEN, OPEN");
+  CHECK (reap (1) == 0, "NOP result");
+  CHECK ((sample_fd = reap (2)) > 1, "OPEN \"sample.txt\" result");
+  CHECK ((test_fd = reap (3)) > 1, "OPEN \"test.txt\" result");
+
+  memset (buf, 0, sizeof buf);
+  queue (RING_OP_READ, sample_fd, buf, half, 0, 4);
+  queue (RING_OP_PREAD, sample_fd, buf + half, size - half, half, 5);
+  queue (RING_OP_PWRITE, test_fd, sample + half, size - half, half, 6);
+  queue (RING_OP_WRITE, test_fd, sample, half, 0, 7);
+  queue (RING_OP_CLOSE, sample_fd, NULL, 0, 0, 8);
+  queue (RING_OP_CLOSE, test_fd, NULL, 0, 0, 9);
+  CHECK (ring_enter (6) == 6, "ring_enter READ, PREAD, PWRITE, WRITE, "
+         "CLOSE, CLOSE");
+  CHECK (reap (4) == (int) half, "READ result");
+  CHECK (reap (5) == (int) (size - half), "PREAD result");
+  CHECK (reap (6) == (int) (size - half), "PWRITE result");
+  CHECK (reap (7) == (int) half, "WRITE result");
+  CHECK (reap (8) == 0, "CLOSE \"sample.txt\" result");
+  CHECK (reap (9) == 0, "CLOSE \"test.txt\" result");
+
+  CHECK (ring->sq_head == ring->sq_tail, "all requests consumed");
+  CHECK (ring->cq_head == ring->cq_tail, "all completions reaped");
+  if (memcmp (buf, sample, size))
+    fail ("READ and PREAD did not read \"sample.txt\"");
+  CHECK (read (sample_fd, buf, 1) == -1, "\"sample.txt\" closed");
+  CHECK (read (test_fd, buf, 1) == -1, "\"test.txt\" closed");
+  check_file ("test.txt", sample, size);
+}
@@ -0,0 +1,30 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(ring-normal) begin
+(ring-normal) ring_setup
+(ring-normal) create "test.txt"
+(ring-normal) ring_enter NOP, OPEN, OPEN
+(ring-normal) NOP result
+(ring-normal) OPEN "sample.txt" result
+(ring-normal) OPEN "test.txt" result
+(ring-normal) ring_enter READ, PREAD, PWRITE, WRITE, CLOSE, CLOSE
+(ring-normal) READ result
+(ring-normal) PREAD result
+(ring-normal) PWRITE result
+(ring-normal) WRITE result
+(ring-normal) CLOSE "sample.txt" result
+(ring-normal) CLOSE "test.txt" result
+(ring-normal) all requests consumed
+(ring-normal) all completions reaped
+(ring-normal) "sample.txt" closed
+(ring-normal) "test.txt" closed
+(ring-normal) open "test.txt" for verification
+(ring-normal) verified contents of "test.txt"
+(ring-normal) close "test.txt"
+(ring-normal) end
+ring-normal: exit(0)
+EOF
+pass;
@@ -0,0 +1,14 @@
+/* Passes an invalid pointer to the I/O vector of the writev
+   system call.  The process must be terminated with -1 exit
+   code. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  writev (1, (struct iovec *) 0xc0100000, 2);
+  fail ("should not have survived writev()");
+}
@@ -0,0 +1,9 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(writev-bad-iov) begin
+writev-bad-iov: exit(-1)
+EOF
+pass;
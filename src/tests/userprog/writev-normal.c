@@ -0,0 +1,32 @@
+/* Write a file with a single writev() call that gathers the data
+   from several buffers, including an empty one, then verify the
+   file's contents. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  size_t size = sizeof sample - 1;
+  struct iovec iov[3];
+  int handle, byte_cnt;
+
+  CHECK (create ("test.txt", size), "create \"test.txt\"");
+  CHECK ((handle = open ("test.txt")) > 1, "open \"test.txt\"");
+
+  iov[0].iov_base = sample;
+  iov[0].iov_len = 16;
+  iov[1].iov_base = sample + 16;
+  iov[1].iov_len = 0;
+  iov[2].iov_base = sample + 16;
+  iov[2].iov_len = size - 16;
+  byte_cnt = writev (handle, iov, 3);
+  if (byte_cnt != (int) size)
+    fail ("writev() returned %d instead of %zu", byte_cnt, size);
+  close (handle);
+
+  check_file ("test.txt", sample, size);
+}
@@ -8,6 +8,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <trace.h>
 #include "devices/kbd.h"
 #include "devices/input.h"
 #include "devices/serial.h"
@@ -20,12 +21,15 @@
 #include "threads/loader.h"
 #include "threads/malloc.h"
 #include "threads/palloc.h"
+#include "threads/profile.h"
 #include "threads/pte.h"
 #include "threads/thread.h"
+#include "threads/tsc.h"
 #ifdef USERPROG
 #include "userprog/process.h"
 #include "userprog/exception.h"
 #include "userprog/gdt.h"
+#include "userprog/pagedir.h"
 #include "userprog/syscall.h"
 #include "userprog/tss.h"
 #else
@@ -57,14 +61,32 @@ static const char *swap_bdev_name;
 /* -ul: Maximum number of pages to put into palloc's user pool. */
 static size_t user_page_limit = SIZE_MAX;
 
+/* Boot-time breakdown: the time stamp counter at the start of
+   main(), when the timer started ticking, and at the end of each
+   phase of startup. */
+#define BOOT_PHASE_MAX 12
+struct boot_phase
+  {
+    const char *name;           /* What was done. */
+    uint64_t tsc;               /* When it was done. */
+  };
+static uint64_t boot_start_tsc;
+static uint64_t boot_timer_tsc;
+static struct boot_phase boot_phases[BOOT_PHASE_MAX];
+static size_t boot_phase_cnt;
+
 static void bss_init (void);
 static void paging_init (void);
+static bool cpu_has_large_pages (void);
 
 static char **read_command_line (void);
 static char **parse_options (char **argv);
 static void run_actions (char **argv);
 static void usage (void);
 
+static void boot_mark (const char *phase);
+static void print_boot_times (void);
+
 #ifdef FILESYS
 static void locate_block_devices (void);
 static void locate_block_device (enum block_type, const char *name);
@@ -80,6 +102,7 @@ main (void)
 
   /* Clear BSS. */  
   bss_init ();
+  boot_start_tsc = read_tsc ();
 
   /* Break command line into arguments and parse options. */
   argv = read_command_line ();
@@ -98,6 +121,9 @@ main (void)
   palloc_init (user_page_limit);
   malloc_init ();
   paging_init ();
+  trace_init ();
+  profile_init ();
+  boot_mark ("memory");
 
   /* Segmentation. */
 #ifdef USERPROG
@@ -111,22 +137,35 @@ main (void)
   kbd_init ();
   input_init ();
 #ifdef USERPROG
+  pagedir_init ();
   exception_init ();
   syscall_init ();
+  process_init ();
 #endif
+  boot_mark ("interrupts");
 
   /* Start thread scheduler and enable interrupts. */
   thread_start ();
+  boot_timer_tsc = read_tsc ();
   serial_init_queue ();
+  boot_mark ("scheduler");
   timer_calibrate ();
+  boot_mark ("timer calibration");
 
 #ifdef FILESYS
-  /* Initialize file system. */
+  /* Initialize file system.  Disks are probed in the background,
+     and the file system starts up as soon as its disk turns up,
+     while any other disks are still being probed. */
   ide_init ();
-  locate_block_devices ();
+  locate_block_device (BLOCK_FILESYS, filesys_bdev_name);
+  boot_mark ("file system disk");
   filesys_init (format_filesys);
+  boot_mark ("file system");
+  locate_block_devices ();
+  boot_mark ("other disks");
 #endif
 
+  print_boot_times ();
   printf ("Boot complete.\n");
   
   /* Run actions specified on kernel command line. */
@@ -150,20 +189,38 @@ bss_init (void)
   memset (&_start_bss, 0, &_end_bss - &_start_bss);
 }
 
+/* CR4 bits.  See [IA32-v3a] 2.5 "Control Registers". */
+#define CR4_PSE 0x00000010      /* Page Size Extensions (4 MB pages). */
+#define CR4_PGE 0x00000080      /* Page Global Enable. */
+
+/* CPUID leaf 1 EDX feature bits. */
+#define CPUID_PSE 0x00000008    /* 4 MB pages supported. */
+#define CPUID_PGE 0x00002000    /* Global pages supported. */
+
 /* Populates the base page directory and page table with the
    kernel virtual mapping, and then sets up the CPU to use the
    new page directory.  Points init_page_dir to the page
-   directory it creates. */
+   directory it creates.
+
+   If the CPU supports them, each 4 MB stretch of RAM that lies
+   entirely within physical memory and holds no kernel text is
+   mapped with a single 4 MB page, and every kernel mapping is
+   global, so that the kernel's translations take few TLB entries
+   and survive the CR3 reloads done on every process switch.  The
+   stretch holding kernel text keeps 4 kB pages so that the text
+   stays read-only. */
 static void
 paging_init (void)
 {
   uint32_t *pd, *pt;
   size_t page;
+  bool large_pages = cpu_has_large_pages ();
+  uint32_t global = large_pages ? PTE_G : 0;
   extern char _start, _end_kernel_text;
 
   pd = init_page_dir = palloc_get_page (PAL_ASSERT | PAL_ZERO);
   pt = NULL;
-  for (page = 0; page < init_ram_pages; page++)
+  for (page = 0; page < init_ram_pages; )
     {
       uintptr_t paddr = page * PGSIZE;
       char *vaddr = ptov (paddr);
@@ -171,13 +228,33 @@ paging_init (void)
       size_t pte_idx = pt_no (vaddr);
       bool in_kernel_text = &_start <= vaddr && vaddr < &_end_kernel_text;
 
+      if (large_pages && pte_idx == 0
+          && page + PTSPAN / PGSIZE <= init_ram_pages
+          && (vaddr + PTSPAN <= &_start || vaddr >= &_end_kernel_text))
+        {
+          pd[pde_idx] = pde_create_large_kernel (vaddr);
+          page += PTSPAN / PGSIZE;
+          continue;
+        }
+
       if (pd[pde_idx] == 0)
         {
           pt = palloc_get_page (PAL_ASSERT | PAL_ZERO);
           pd[pde_idx] = pde_create (pt);
         }
 
-      pt[pte_idx] = pte_create_kernel (vaddr, !in_kernel_text);
+      pt[pte_idx] = pte_create_kernel (vaddr, !in_kernel_text) | global;
+      page++;
+    }
+
+  /* Turn on 4 MB pages and global pages before any mapping that
+     uses them becomes active. */
+  if (large_pages)
+    {
+      uint32_t cr4;
+      asm volatile ("movl %%cr4, %0" : "=r" (cr4));
+      cr4 |= CR4_PSE | CR4_PGE;
+      asm volatile ("movl %0, %%cr4" : : "r" (cr4));
     }
 
   /* Store the physical address of the page directory into CR3
@@ -188,6 +265,19 @@ paging_init (void)
   asm volatile ("movl %0, %%cr3" : : "r" (vtop (init_page_dir)));
 }
 
+/* Returns true if the CPU supports both 4 MB pages (PSE) and
+   global pages (PGE), according to CPUID.  See [IA32-v2a]
+   "CPUID--CPU Identification". */
+static bool
+cpu_has_large_pages (void)
+{
+  uint32_t eax = 1, ebx, ecx = 0, edx;
+
+  asm volatile ("cpuid"
+                : "+a" (eax), "=b" (ebx), "+c" (ecx), "=d" (edx));
+  return (edx & CPUID_PSE) && (edx & CPUID_PGE);
+}
+
 /* Breaks the kernel command line into words and returns them as
    an argv-like array. */
 static char **
@@ -247,6 +337,8 @@ parse_options (char **argv)
         filesys_bdev_name = value;
       else if (!strcmp (name, "-scratch"))
         scratch_bdev_name = value;
+      else if (!strcmp (name, "-v"))
+        fsutil_verbose = true;
 #ifdef VM
       else if (!strcmp (name, "-swap"))
         swap_bdev_name = value;
@@ -254,11 +346,29 @@ parse_options (char **argv)
 #endif
       else if (!strcmp (name, "-rs"))
         random_init (atoi (value));
+      else if (!strcmp (name, "-calibrate"))
+        timer_set_calibration (value);
       else if (!strcmp (name, "-mlfqs"))
         thread_mlfqs = true;
+      else if (!strcmp (name, "-profile"))
+        profile_enabled = true;
+      else if (!strcmp (name, "-trace"))
+        trace_configure (value);
+#ifdef FILESYS
+      else if (!strcmp (name, "-trace-dump"))
+        trace_request_dump ();
+#endif
 #ifdef USERPROG
       else if (!strcmp (name, "-ul"))
         user_page_limit = atoi (value);
+      else if (!strcmp (name, "-stack"))
+        {
+          int pages = value != NULL ? atoi (value) : 0;
+          if (pages < 1 || (uintptr_t) pages > (uintptr_t) PHYS_BASE / PGSIZE)
+            PANIC ("-stack requires a page count from 1 to %"PRIuPTR,
+                   (uintptr_t) PHYS_BASE / PGSIZE);
+          process_stack_limit = pages;
+        }
 #endif
       else
         PANIC ("unknown option `%s' (use -h for help)", name);
@@ -373,25 +483,86 @@ usage (void)
           "  -f                 Format file system device during startup.\n"
           "  -filesys=BDEV      Use BDEV for file system instead of default.\n"
           "  -scratch=BDEV      Use BDEV for scratch instead of default.\n"
+          "  -v                 List each file extracted from scratch.\n"
 #ifdef VM
           "  -swap=BDEV         Use BDEV for swap instead of default.\n"
 #endif
 #endif
           "  -rs=SEED           Set random number seed to SEED.\n"
+          "  -calibrate=RATE    Skip timer calibration, using RATE loops/s\n"
+          "                     as printed by an earlier boot.\n"
           "  -mlfqs             Use multi-level feedback queue scheduler.\n"
+          "  -profile           Sample kernel call stacks on timer ticks.\n"
+          "  -trace=SUBSYS,...  Trace SUBSYS (thread intr syscall process\n"
+          "                     filesys all) into the trace buffer.\n"
+#ifdef FILESYS
+          "  -trace-dump        Append trace buffer to scratch at power off.\n"
+#endif
 #ifdef USERPROG
           "  -ul=COUNT          Limit user memory to COUNT pages.\n"
+          "  -stack=COUNT       Limit each user stack to COUNT pages.\n"
 #endif
           );
   shutdown_power_off ();
 }
 
+/* Records that the boot phase named PHASE has just finished. */
+static void
+boot_mark (const char *phase) 
+{
+  if (boot_phase_cnt < BOOT_PHASE_MAX)
+    {
+      struct boot_phase *p = &boot_phases[boot_phase_cnt++];
+      p->name = phase;
+      p->tsc = read_tsc ();
+    }
+}
+
+/* Prints the time taken by each phase recorded by boot_mark().
+   Times are measured with the time stamp counter, whose rate is
+   found by comparing it against the timer over the part of boot
+   since the timer started.  If too few timer ticks have passed
+   to tell, prints cycles instead. */
+static void
+print_boot_times (void) 
+{
+  uint64_t now = read_tsc ();
+  int64_t ticks = timer_ticks ();
+  uint64_t cycles_per_ms = 0;
+  uint64_t prev = boot_start_tsc;
+  size_t i;
+
+  if (ticks >= TIMER_FREQ / 10)
+    cycles_per_ms = (now - boot_timer_tsc) * TIMER_FREQ / (ticks * 1000);
+
+  for (i = 0; i <= boot_phase_cnt; i++)
+    {
+      const char *name = i < boot_phase_cnt ? boot_phases[i].name : "total";
+      uint64_t cycles = (i < boot_phase_cnt ? boot_phases[i].tsc - prev
+                         : now - boot_start_tsc);
+
+      if (cycles_per_ms != 0)
+        {
+          uint64_t us = cycles * 1000 / cycles_per_ms;
+          printf ("Boot time: %-18s %5"PRIu64".%03"PRIu64" ms\n",
+                  name, us / 1000, us % 1000);
+        }
+      else
+        printf ("Boot time: %-18s %'12"PRIu64" cycles\n", name, cycles);
+      if (i < boot_phase_cnt)
+        prev = boot_phases[i].tsc;
+    }
+}
+
 #ifdef FILESYS
-/* Figure out what block devices to cast in the various Pintos roles. */
+/* Waits for the rest of the disks to be probed, then figures out
+   what block devices to cast in the Pintos roles other than
+   file system, which main() has already cast. */
 static void
 locate_block_devices (void)
 {
-  locate_block_device (BLOCK_FILESYS, filesys_bdev_name);
+  while (ide_probe_next ())
+    continue;
   locate_block_device (BLOCK_SCRATCH, scratch_bdev_name);
 #ifdef VM
   locate_block_device (BLOCK_SWAP, swap_bdev_name);
@@ -401,24 +572,29 @@ locate_block_devices (void)
 /* Figures out what block device to use for the given ROLE: the
    block device with the given NAME, if NAME is non-null,
    otherwise the first block device in probe order of type
-   ROLE. */
+   ROLE.  Waits for disks to be probed until one is found or
+   there are no more. */
 static void
 locate_block_device (enum block_type role, const char *name)
 {
-  struct block *block = NULL;
+  struct block *block;
 
-  if (name != NULL)
+  for (;;)
     {
-      block = block_get_by_name (name);
-      if (block == NULL)
-        PANIC ("No such block device \"%s\"", name);
-    }
-  else
-    {
-      for (block = block_first (); block != NULL; block = block_next (block))
-        if (block_type (block) == role)
-          break;
+      if (name != NULL)
+        block = block_get_by_name (name);
+      else
+        {
+          for (block = block_first (); block != NULL;
+               block = block_next (block))
+            if (block_type (block) == role)
+              break;
+        }
+      if (block != NULL || !ide_probe_next ())
+        break;
     }
+  if (name != NULL && block == NULL)
+    PANIC ("No such block device \"%s\"", name);
 
   if (block != NULL)
     {
@@ -3,6 +3,7 @@
 #include <inttypes.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <trace.h>
 #include "threads/flags.h"
 #include "threads/intr-stubs.h"
 #include "threads/io.h"
@@ -359,6 +360,7 @@ intr_handler (struct intr_frame *frame)
 
       in_external_intr = true;
       yield_on_return = false;
+      TRACE (TRACE_INTR_ENTER, frame->vec_no, 0, 0);
     }
 
   /* Invoke the interrupt's handler. */
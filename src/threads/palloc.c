@@ -7,6 +7,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include "threads/interrupt.h"
 #include "threads/loader.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
@@ -23,22 +24,36 @@
 
    By default, half of system RAM is given to the kernel pool and
    half to the user pool.  That should be huge overkill for the
-   kernel pool, but that's just fine for demonstration purposes. */
+   kernel pool, but that's just fine for demonstration purposes.
+
+   Each free page is either "dirty", with unknown contents, or
+   known to be all zeros.  The idle thread zeroes dirty free pages
+   whenever nothing else is ready to run (see
+   palloc_zero_idle_page()), so that PAL_ZERO requests can usually
+   be served without touching memory. */
 
 /* A memory pool. */
 struct pool
   {
     struct lock lock;                   /* Mutual exclusion. */
     struct bitmap *used_map;            /* Bitmap of free pages. */
+    struct bitmap *dirty_map;           /* Free pages not yet zeroed. */
+    struct bitmap *zero_map;            /* Free pages known to be zero. */
     uint8_t *base;                      /* Base of pool. */
   };
 
 /* Two pools: one for kernel data, one for user pages. */
 static struct pool kernel_pool, user_pool;
 
+/* Statistics. */
+static long long zeroed_cnt;            /* Pages zeroed by idle thread. */
+static long long zero_hit_cnt;          /* PAL_ZERO pages already zero. */
+static long long zero_miss_cnt;         /* PAL_ZERO pages zeroed inline. */
+
 static void init_pool (struct pool *, void *base, size_t page_cnt,
                        const char *name);
 static bool page_from_pool (const struct pool *, void *page);
+static bool zero_one_page (struct pool *);
 
 /* Initializes the page allocator.  At most USER_PAGE_LIMIT
    pages are put into the user pool. */
@@ -73,12 +88,34 @@ palloc_get_multiple (enum palloc_flags flags, size_t page_cnt)
   struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
   void *pages;
   size_t page_idx;
+  bool zeroed = false;
 
   if (page_cnt == 0)
     return NULL;
 
   lock_acquire (&pool->lock);
-  page_idx = bitmap_scan_and_flip (pool->used_map, 0, page_cnt, false);
+
+  /* A single page can come from the free list that suits FLAGS:
+     a zeroed page for PAL_ZERO, otherwise a dirty page, to leave
+     zeroed pages for PAL_ZERO requests. */
+  page_idx = BITMAP_ERROR;
+  if (page_cnt == 1)
+    {
+      struct bitmap *preferred = (flags & PAL_ZERO
+                                  ? pool->zero_map : pool->dirty_map);
+      page_idx = bitmap_scan (preferred, 0, 1, true);
+      if (page_idx != BITMAP_ERROR)
+        bitmap_mark (pool->used_map, page_idx);
+    }
+  if (page_idx == BITMAP_ERROR)
+    page_idx = bitmap_scan_and_flip (pool->used_map, 0, page_cnt, false);
+
+  if (page_idx != BITMAP_ERROR)
+    {
+      zeroed = bitmap_all (pool->zero_map, page_idx, page_cnt);
+      bitmap_set_multiple (pool->dirty_map, page_idx, page_cnt, false);
+      bitmap_set_multiple (pool->zero_map, page_idx, page_cnt, false);
+    }
   lock_release (&pool->lock);
 
   if (page_idx != BITMAP_ERROR)
@@ -89,7 +126,15 @@ palloc_get_multiple (enum palloc_flags flags, size_t page_cnt)
   if (pages != NULL) 
     {
       if (flags & PAL_ZERO)
-        memset (pages, 0, PGSIZE * page_cnt);
+        {
+          if (zeroed)
+            zero_hit_cnt += page_cnt;
+          else
+            {
+              memset (pages, 0, PGSIZE * page_cnt);
+              zero_miss_cnt += page_cnt;
+            }
+        }
     }
   else 
     {
@@ -119,6 +164,7 @@ palloc_free_multiple (void *pages, size_t page_cnt)
 {
   struct pool *pool;
   size_t page_idx;
+  enum intr_level old_level;
 
   ASSERT (pg_ofs (pages) == 0);
   if (pages == NULL || page_cnt == 0)
@@ -138,7 +184,16 @@ palloc_free_multiple (void *pages, size_t page_cnt)
 #endif
 
   ASSERT (bitmap_all (pool->used_map, page_idx, page_cnt));
+
+  /* This may run in thread_schedule_tail(), where the pool lock
+     can't be taken.  Disabling interrupts makes the pages' move to
+     the dirty free list atomic with respect to threads holding
+     the lock, which only ever touch pages that are free or that
+     they own. */
+  old_level = intr_disable ();
+  bitmap_set_multiple (pool->dirty_map, page_idx, page_cnt, true);
   bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+  intr_set_level (old_level);
 }
 
 /* Frees the page at PAGE. */
@@ -148,27 +203,100 @@ palloc_free_page (void *page)
   palloc_free_multiple (page, 1);
 }
 
+/* Zeroes one dirty free page, if there is one, moving it to its
+   pool's list of zeroed pages.  Returns true if a page was
+   zeroed, false if there was nothing to do or the pools were
+   locked.
+
+   Called by the idle thread, which must never block.  It must
+   not hold a pool lock either: the idle thread runs only when
+   nothing else is ready, so a thread that blocked on a lock held
+   by a preempted idle thread could wait indefinitely. */
+bool
+palloc_zero_idle_page (void)
+{
+  return zero_one_page (&user_pool) || zero_one_page (&kernel_pool);
+}
+
+/* Prints page allocator statistics. */
+void
+palloc_print_stats (void)
+{
+  printf ("Page zeroing: %lld pages zeroed when idle, "
+          "%lld PAL_ZERO pages pre-zeroed, %lld zeroed inline\n",
+          zeroed_cnt, zero_hit_cnt, zero_miss_cnt);
+}
+
 /* Initializes pool P as starting at START and ending at END,
    naming it NAME for debugging purposes. */
 static void
 init_pool (struct pool *p, void *base, size_t page_cnt, const char *name) 
 {
-  /* We'll put the pool's used_map at its base.
-     Calculate the space needed for the bitmap
+  /* We'll put the pool's bitmaps at its base.
+     Calculate the space needed for the bitmaps
      and subtract it from the pool's size. */
-  size_t bm_pages = DIV_ROUND_UP (bitmap_buf_size (page_cnt), PGSIZE);
+  size_t bm_size = bitmap_buf_size (page_cnt);
+  size_t bm_pages = DIV_ROUND_UP (3 * bm_size, PGSIZE);
   if (bm_pages > page_cnt)
     PANIC ("Not enough memory in %s for bitmap.", name);
   page_cnt -= bm_pages;
+  bm_size = bitmap_buf_size (page_cnt);
 
   printf ("%zu pages available in %s.\n", page_cnt, name);
 
-  /* Initialize the pool. */
+  /* Initialize the pool.  All of its pages start out free, with
+     unknown contents. */
   lock_init (&p->lock);
-  p->used_map = bitmap_create_in_buf (page_cnt, base, bm_pages * PGSIZE);
+  p->used_map = bitmap_create_in_buf (page_cnt, base, bm_size);
+  p->dirty_map = bitmap_create_in_buf (page_cnt, base + bm_size, bm_size);
+  p->zero_map = bitmap_create_in_buf (page_cnt, base + 2 * bm_size,
+                                      bm_size);
+  bitmap_set_all (p->dirty_map, true);
   p->base = base + bm_pages * PGSIZE;
 }
 
+/* Zeroes one dirty free page in POOL, if there is one and no
+   other thread holds POOL's lock.  Returns true if a page was
+   zeroed.
+
+   The whole job runs with interrupts off, which takes about as
+   long as copying a page.  That way the idle thread never holds
+   the pool lock or keeps a page out of the free lists while
+   another thread runs.  Under priority scheduling the idle
+   thread runs only when no other thread is ready, and once
+   preempted it may not run again for a long time, so anything
+   it held would be withheld from every palloc caller meanwhile.
+   As it is, a palloc caller never waits for the idle thread. */
+static bool
+zero_one_page (struct pool *pool)
+{
+  size_t page_idx;
+  enum intr_level old_level;
+
+  old_level = intr_disable ();
+
+  /* A thread holding the lock may be partway through scanning
+     the bitmaps.  Leave the pool alone until it is done.  The
+     lock's holder is set only once the lock is taken and cleared
+     before it is let go, so a thread that is just acquiring or
+     releasing the lock is not touching the bitmaps. */
+  if (pool->lock.holder != NULL)
+    page_idx = BITMAP_ERROR;
+  else
+    page_idx = bitmap_scan (pool->dirty_map, 0, 1, true);
+
+  if (page_idx != BITMAP_ERROR)
+    {
+      memset (pool->base + PGSIZE * page_idx, 0, PGSIZE);
+      bitmap_reset (pool->dirty_map, page_idx);
+      bitmap_mark (pool->zero_map, page_idx);
+      zeroed_cnt++;
+    }
+  intr_set_level (old_level);
+
+  return page_idx != BITMAP_ERROR;
+}
+
 /* Returns true if PAGE was allocated from POOL,
    false otherwise. */
 static bool
@@ -0,0 +1,142 @@
+#include "threads/profile.h"
+#include <debug.h>
+#include <hash.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/loader.h"
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
+
+/* Pages given to the histogram. */
+#define PROFILE_PAGES 16
+
+/* Maximum number of addresses recorded per sample: the
+   interrupted instruction, then return addresses. */
+#define PROFILE_DEPTH 7
+
+/* Buckets examined before a new stack is dropped. */
+#define PROFILE_PROBES 16
+
+/* A distinct call stack and the number of samples that hit it. */
+struct profile_bucket
+  {
+    uint32_t count;                     /* Samples; 0 if unused. */
+    uintptr_t pcs[PROFILE_DEPTH];       /* Null-padded addresses. */
+  };
+
+/* True if "-profile" was given on the kernel command line. */
+bool profile_enabled;
+
+/* Open-addressed histogram of call stacks.  Only touched by the
+   timer interrupt handler, so it needs no locking. */
+static struct profile_bucket *buckets;
+static size_t bucket_cnt;
+
+/* Statistics. */
+static long long kernel_samples;        /* Samples in kernel code. */
+static long long user_samples;          /* Samples in user code. */
+static long long dropped_samples;       /* Kernel samples not kept. */
+
+/* Allocates the histogram if profiling is enabled.  It must be
+   allocated before the timer starts interrupting, because the
+   interrupt handler can't allocate memory. */
+void
+profile_init (void)
+{
+  if (!profile_enabled)
+    return;
+
+  buckets = palloc_get_multiple (PAL_ZERO, PROFILE_PAGES);
+  if (buckets == NULL)
+    {
+      printf ("profile: no memory for histogram, profiling disabled\n");
+      profile_enabled = false;
+      return;
+    }
+  bucket_cnt = PROFILE_PAGES * PGSIZE / sizeof *buckets;
+}
+
+/* Records a sample of the code interrupted by the timer
+   interrupt whose frame is F.  Called with interrupts off. */
+void
+profile_sample (const struct intr_frame *f)
+{
+  uintptr_t pcs[PROFILE_DEPTH];
+  uintptr_t stack = (uintptr_t) pg_round_down (f);
+  uintptr_t *frame;
+  unsigned hash;
+  size_t depth, i;
+
+  if (buckets == NULL)
+    return;
+  if (f->cs != SEL_KCSEG)
+    {
+      user_samples++;
+      return;
+    }
+  kernel_samples++;
+
+  /* Walk the saved frame pointers.  Kernel code interrupted in
+     kernel mode runs on the same stack page as F, so stop at the
+     first frame outside that page or not above the previous one,
+     which also copes with functions built without a frame
+     pointer. */
+  memset (pcs, 0, sizeof pcs);
+  pcs[0] = (uintptr_t) f->eip;
+  depth = 1;
+  frame = (uintptr_t *) f->ebp;
+  while (depth < PROFILE_DEPTH
+         && (uintptr_t) frame > (uintptr_t) f
+         && (uintptr_t) frame - stack <= PGSIZE - 2 * sizeof *frame)
+    {
+      pcs[depth++] = frame[1];
+      if (frame[0] <= (uintptr_t) frame)
+        break;
+      frame = (uintptr_t *) frame[0];
+    }
+
+  /* Count the stack in its bucket, claiming an empty one for a
+     stack not seen before. */
+  hash = hash_bytes (pcs, sizeof pcs);
+  for (i = 0; i < PROFILE_PROBES; i++)
+    {
+      struct profile_bucket *b = &buckets[(hash + i) % bucket_cnt];
+      if (b->count == 0)
+        memcpy (b->pcs, pcs, sizeof pcs);
+      else if (memcmp (b->pcs, pcs, sizeof pcs))
+        continue;
+      b->count++;
+      return;
+    }
+  dropped_samples++;
+}
+
+/* Prints the histogram, one "Profile stack:" line per distinct
+   call stack, in a form that "backtrace --profile" reads. */
+void
+profile_print (void)
+{
+  size_t i;
+
+  if (buckets == NULL)
+    return;
+
+  printf ("Profile: %lld kernel samples, %lld user samples, "
+          "%lld dropped.\n",
+          kernel_samples, user_samples, dropped_samples);
+  for (i = 0; i < bucket_cnt; i++)
+    {
+      const struct profile_bucket *b = &buckets[i];
+      size_t j;
+
+      if (b->count == 0)
+        continue;
+      printf ("Profile stack: %"PRIu32, b->count);
+      for (j = 0; j < PROFILE_DEPTH && b->pcs[j] != 0; j++)
+        printf (" %#"PRIxPTR, b->pcs[j]);
+      printf ("\n");
+    }
+  printf ("Profile end.\n");
+}
@@ -0,0 +1,21 @@
+#ifndef THREADS_PROFILE_H
+#define THREADS_PROFILE_H
+
+#include <stdbool.h>
+#include "threads/interrupt.h"
+
+/* Sampling profiler.
+
+   When enabled with the kernel's "-profile" option, every timer
+   interrupt records the interrupted kernel instruction and a
+   short frame-pointer backtrace into a histogram, which is
+   printed at power off.  Run the output through
+   "backtrace --profile" for flat and call-graph profiles. */
+
+extern bool profile_enabled;
+
+void profile_init (void);
+void profile_sample (const struct intr_frame *);
+void profile_print (void);
+
+#endif /* threads/profile.h */
@@ -47,7 +47,7 @@ sema_init (struct semaphore *sema, unsigned value)
   ASSERT (sema != NULL);
 
   sema->value = value;
-  list_init (&sema->waiters);
+  heap_init (&sema->waiters, thread_higher_priority, NULL);
 }
 
 /* Down or "P" operation on a semaphore.  Waits for SEMA's value
@@ -68,7 +68,7 @@ sema_down (struct semaphore *sema)
   old_level = intr_disable ();
   while (sema->value == 0) 
     {
-      list_push_back (&sema->waiters, &thread_current ()->elem);
+      heap_insert (&sema->waiters, &thread_current ()->elem);
       thread_block ();
     }
   sema->value--;
@@ -102,7 +102,9 @@ sema_try_down (struct semaphore *sema)
 }
 
 /* Up or "V" operation on a semaphore.  Increments SEMA's value
-   and wakes up one thread of those waiting for SEMA, if any.
+   and wakes up one thread of those waiting for SEMA, if any: the
+   one with the highest priority, or the longest waiting of
+   those.
 
    This function may be called from an interrupt handler. */
 void
@@ -113,8 +115,8 @@ sema_up (struct semaphore *sema)
   ASSERT (sema != NULL);
 
   old_level = intr_disable ();
-  if (!list_empty (&sema->waiters)) 
-    thread_unblock (list_entry (list_pop_front (&sema->waiters),
+  if (!heap_empty (&sema->waiters)) 
+    thread_unblock (heap_entry (heap_pop (&sema->waiters),
                                 struct thread, elem));
   sema->value++;
   intr_set_level (old_level);
@@ -246,13 +248,17 @@ lock_held_by_current_thread (const struct lock *lock)
   return lock->holder == thread_current ();
 }
 
-/* One semaphore in a list. */
+/* One semaphore in a condition's wait queue. */
 struct semaphore_elem 
   {
-    struct list_elem elem;              /* List element. */
+    struct heap_elem elem;              /* Heap element. */
     struct semaphore semaphore;         /* This semaphore. */
+    int priority;                       /* Waiting thread's priority. */
   };
 
+static bool waiter_higher_priority (const struct heap_elem *,
+                                    const struct heap_elem *, void *aux);
+
 /* Initializes condition variable COND.  A condition variable
    allows one piece of code to signal a condition and cooperating
    code to receive the signal and act upon it. */
@@ -261,7 +267,7 @@ cond_init (struct condition *cond)
 {
   ASSERT (cond != NULL);
 
-  list_init (&cond->waiters);
+  heap_init (&cond->waiters, waiter_higher_priority, NULL);
 }
 
 /* Atomically releases LOCK and waits for COND to be signaled by
@@ -295,14 +301,17 @@ cond_wait (struct condition *cond, struct lock *lock)
   ASSERT (lock_held_by_current_thread (lock));
   
   sema_init (&waiter.semaphore, 0);
-  list_push_back (&cond->waiters, &waiter.elem);
+  waiter.priority = thread_get_priority ();
+  heap_insert (&cond->waiters, &waiter.elem);
   lock_release (lock);
   sema_down (&waiter.semaphore);
   lock_acquire (lock);
 }
 
 /* If any threads are waiting on COND (protected by LOCK), then
-   this function signals one of them to wake up from its wait.
+   this function signals one of them to wake up from its wait:
+   the one with the highest priority, or the longest waiting of
+   those.
    LOCK must be held before calling this function.
 
    An interrupt handler cannot acquire a lock, so it does not
@@ -316,8 +325,8 @@ cond_signal (struct condition *cond, struct lock *lock UNUSED)
   ASSERT (!intr_context ());
   ASSERT (lock_held_by_current_thread (lock));
 
-  if (!list_empty (&cond->waiters)) 
-    sema_up (&list_entry (list_pop_front (&cond->waiters),
+  if (!heap_empty (&cond->waiters)) 
+    sema_up (&heap_entry (heap_pop (&cond->waiters),
                           struct semaphore_elem, elem)->semaphore);
 }
 
@@ -333,6 +342,233 @@ cond_broadcast (struct condition *cond, struct lock *lock)
   ASSERT (cond != NULL);
   ASSERT (lock != NULL);
 
-  while (!list_empty (&cond->waiters))
+  while (!heap_empty (&cond->waiters))
     cond_signal (cond, lock);
 }
+
+/* Returns true if the thread waiting on semaphore_elem A has
+   higher priority than the one waiting on B. */
+static bool
+waiter_higher_priority (const struct heap_elem *a_,
+                        const struct heap_elem *b_, void *aux UNUSED)
+{
+  const struct semaphore_elem *a
+    = heap_entry (a_, struct semaphore_elem, elem);
+  const struct semaphore_elem *b
+    = heap_entry (b_, struct semaphore_elem, elem);
+
+  return a->priority > b->priority;
+}
+
+/* Initializes RW as a readers-writer lock.  Any number of
+   readers may hold RW at once, or a single writer, but not
+   both.  In addition, one thread may hold RW for upgradeable
+   reading, which admits ordinary readers but excludes writers
+   and other upgradeable readers.
+
+   RW prefers writers: a reader that arrives while a writer is
+   waiting waits until that writer is done.  Like a lock, RW is
+   not recursive and must not be used within an interrupt
+   handler. */
+void
+rwlock_init (struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+
+  lock_init (&rw->lock);
+  cond_init (&rw->readers);
+  cond_init (&rw->writers);
+  cond_init (&rw->upgrade);
+  rw->reader_cnt = 0;
+  rw->writer_waiters = 0;
+  rw->writer = NULL;
+  rw->upgrader = NULL;
+}
+
+/* Acquires RW for reading, sleeping while a writer holds it or
+   is waiting for it. */
+void
+rwlock_acquire_read (struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+
+  lock_acquire (&rw->lock);
+  while (rw->writer != NULL || rw->writer_waiters > 0)
+    cond_wait (&rw->readers, &rw->lock);
+  rw->reader_cnt++;
+  lock_release (&rw->lock);
+}
+
+/* Releases RW, which the current thread must hold for
+   reading. */
+void
+rwlock_release_read (struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+
+  lock_acquire (&rw->lock);
+  ASSERT (rw->reader_cnt > 0);
+  if (--rw->reader_cnt == 0)
+    {
+      /* An upgrader waiting to write goes ahead of writers. */
+      if (rw->upgrader != NULL)
+        cond_signal (&rw->upgrade, &rw->lock);
+      else
+        cond_signal (&rw->writers, &rw->lock);
+    }
+  lock_release (&rw->lock);
+}
+
+/* Acquires RW for writing, sleeping until no other thread holds
+   it. */
+void
+rwlock_acquire_write (struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+
+  lock_acquire (&rw->lock);
+  ASSERT (rw->writer != thread_current ());
+  ASSERT (rw->upgrader != thread_current ());
+  rw->writer_waiters++;
+  while (rw->writer != NULL || rw->upgrader != NULL || rw->reader_cnt > 0)
+    cond_wait (&rw->writers, &rw->lock);
+  rw->writer_waiters--;
+  rw->writer = thread_current ();
+  lock_release (&rw->lock);
+}
+
+/* Wakes the threads that may enter RW now that it has neither a
+   writer nor an upgradeable reader: a waiting writer if there is
+   one, otherwise every waiting reader.  RW's internal lock must
+   be held. */
+static void
+rwlock_wake (struct rwlock *rw)
+{
+  if (rw->writer_waiters > 0)
+    cond_signal (&rw->writers, &rw->lock);
+  else
+    cond_broadcast (&rw->readers, &rw->lock);
+}
+
+/* Releases RW, which the current thread must hold for writing,
+   either directly or by upgrading. */
+void
+rwlock_release_write (struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+
+  lock_acquire (&rw->lock);
+  ASSERT (rw->writer == thread_current ());
+  rw->writer = NULL;
+  rwlock_wake (rw);
+  lock_release (&rw->lock);
+}
+
+/* Acquires RW for upgradeable reading, sleeping while another
+   thread holds it for writing or upgradeable reading, or while a
+   writer is waiting. */
+void
+rwlock_acquire_upgradeable (struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+
+  lock_acquire (&rw->lock);
+  ASSERT (rw->writer != thread_current ());
+  ASSERT (rw->upgrader != thread_current ());
+  while (rw->writer != NULL || rw->upgrader != NULL
+         || rw->writer_waiters > 0)
+    cond_wait (&rw->readers, &rw->lock);
+  rw->upgrader = thread_current ();
+  lock_release (&rw->lock);
+}
+
+/* Releases RW, which the current thread must hold for
+   upgradeable reading. */
+void
+rwlock_release_upgradeable (struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+
+  lock_acquire (&rw->lock);
+  ASSERT (rw->upgrader == thread_current ());
+  rw->upgrader = NULL;
+  if (rw->reader_cnt == 0 || rw->writer_waiters == 0)
+    rwlock_wake (rw);
+  lock_release (&rw->lock);
+}
+
+/* Converts the current thread's upgradeable read hold on RW
+   into a write hold, sleeping until the ordinary readers have
+   left.  Since no writer can enter while the upgradeable hold
+   is in place, the data read under it is still current once
+   this function returns.  Release RW with
+   rwlock_release_write(). */
+void
+rwlock_upgrade (struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+
+  lock_acquire (&rw->lock);
+  ASSERT (rw->upgrader == thread_current ());
+  rw->writer_waiters++;
+  while (rw->reader_cnt > 0)
+    cond_wait (&rw->upgrade, &rw->lock);
+  rw->writer_waiters--;
+  rw->upgrader = NULL;
+  rw->writer = thread_current ();
+  lock_release (&rw->lock);
+}
+
+/* Initializes BARRIER for rounds of THREAD_CNT threads.  Each
+   thread that calls barrier_wait() sleeps until THREAD_CNT
+   threads in all have called it, and then they all continue.
+   BARRIER may then be used for another round. */
+void
+barrier_init (struct barrier *barrier, unsigned thread_cnt)
+{
+  ASSERT (barrier != NULL);
+  ASSERT (thread_cnt > 0);
+
+  lock_init (&barrier->lock);
+  cond_init (&barrier->released);
+  barrier->thread_cnt = thread_cnt;
+  barrier->waiting = 0;
+  barrier->round = 0;
+}
+
+/* Waits on BARRIER until the current round is complete.
+   Returns true in exactly one thread of each round, the last
+   to arrive, and false in the others, so that per-round work
+   can be assigned to a single thread.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+bool
+barrier_wait (struct barrier *barrier)
+{
+  bool last;
+
+  ASSERT (barrier != NULL);
+  ASSERT (!intr_context ());
+
+  lock_acquire (&barrier->lock);
+  last = ++barrier->waiting == barrier->thread_cnt;
+  if (last)
+    {
+      barrier->waiting = 0;
+      barrier->round++;
+      cond_broadcast (&barrier->released, &barrier->lock);
+    }
+  else
+    {
+      unsigned round = barrier->round;
+      while (round == barrier->round)
+        cond_wait (&barrier->released, &barrier->lock);
+    }
+  lock_release (&barrier->lock);
+  return last;
+}
@@ -1,14 +1,14 @@
 #ifndef THREADS_SYNCH_H
 #define THREADS_SYNCH_H
 
-#include <list.h>
+#include <heap.h>
 #include <stdbool.h>
 
 /* A counting semaphore. */
 struct semaphore 
   {
     unsigned value;             /* Current value. */
-    struct list waiters;        /* List of waiting threads. */
+    struct heap waiters;        /* Waiting threads, by priority. */
   };
 
 void sema_init (struct semaphore *, unsigned value);
@@ -33,7 +33,7 @@ bool lock_held_by_current_thread (const struct lock *);
 /* Condition variable. */
 struct condition 
   {
-    struct list waiters;        /* List of waiting threads. */
+    struct heap waiters;        /* Waiting threads, by priority. */
   };
 
 void cond_init (struct condition *);
@@ -41,6 +41,46 @@ void cond_wait (struct condition *, struct lock *);
 void cond_signal (struct condition *, struct lock *);
 void cond_broadcast (struct condition *, struct lock *);
 
+/* Readers-writer lock.
+
+   Writers are preferred: once a writer is waiting, new readers
+   wait behind it.  One thread at a time may also hold the lock
+   for upgradeable reading, alongside ordinary readers, and later
+   upgrade to writing without letting another writer in first. */
+struct rwlock
+  {
+    struct lock lock;           /* Protects the members below. */
+    struct condition readers;   /* Signaled when readers may enter. */
+    struct condition writers;   /* Signaled when a writer may enter. */
+    struct condition upgrade;   /* Signaled when the upgrader may write. */
+    unsigned reader_cnt;        /* Number of ordinary readers. */
+    unsigned writer_waiters;    /* Writers waiting, including upgrader. */
+    struct thread *writer;      /* Writer holding the lock, if any. */
+    struct thread *upgrader;    /* Upgradeable reader, if any. */
+  };
+
+void rwlock_init (struct rwlock *);
+void rwlock_acquire_read (struct rwlock *);
+void rwlock_release_read (struct rwlock *);
+void rwlock_acquire_write (struct rwlock *);
+void rwlock_release_write (struct rwlock *);
+void rwlock_acquire_upgradeable (struct rwlock *);
+void rwlock_release_upgradeable (struct rwlock *);
+void rwlock_upgrade (struct rwlock *);
+
+/* Barrier. */
+struct barrier
+  {
+    struct lock lock;           /* Protects the members below. */
+    struct condition released;  /* Signaled when a round completes. */
+    unsigned thread_cnt;        /* Threads per round. */
+    unsigned waiting;           /* Threads waiting in this round. */
+    unsigned round;             /* Number of completed rounds. */
+  };
+
+void barrier_init (struct barrier *, unsigned thread_cnt);
+bool barrier_wait (struct barrier *);
+
 /* Optimization barrier.
 
    The compiler will not reorder operations across an
@@ -4,6 +4,7 @@
 #include <random.h>
 #include <stdio.h>
 #include <string.h>
+#include <trace.h>
 #include "threads/flags.h"
 #include "threads/interrupt.h"
 #include "threads/intr-stubs.h"
@@ -21,9 +22,10 @@
    of thread.h for details. */
 #define THREAD_MAGIC 0xcd6abf4b
 
-/* List of processes in THREAD_READY state, that is, processes
-   that are ready to run but not actually running. */
-static struct list ready_list;
+/* Processes in THREAD_READY state, that is, processes that are
+   ready to run but not actually running.  Highest priority
+   first, and first come, first served among equal priorities. */
+static struct heap ready_queue;
 
 /* List of all processes.  Processes are added to this list
    when they are first scheduled and removed when they exit. */
@@ -93,7 +95,7 @@ thread_init (void)
   ASSERT (intr_get_level () == INTR_OFF);
 
   lock_init (&tid_lock);
-  list_init (&ready_list);
+  heap_init (&ready_queue, thread_higher_priority, NULL);
   list_init (&all_list);
 
   /* Set up a thread structure for the running thread. */
@@ -245,7 +247,7 @@ thread_unblock (struct thread *t)
 
   old_level = intr_disable ();
   ASSERT (t->status == THREAD_BLOCKED);
-  list_push_back (&ready_list, &t->elem);
+  heap_insert (&ready_queue, &t->elem);
   t->status = THREAD_READY;
   intr_set_level (old_level);
 }
@@ -316,7 +318,7 @@ thread_yield (void)
 
   old_level = intr_disable ();
   if (cur != idle_thread) 
-    list_push_back (&ready_list, &cur->elem);
+    heap_insert (&ready_queue, &cur->elem);
   cur->status = THREAD_READY;
   schedule ();
   intr_set_level (old_level);
@@ -353,6 +355,19 @@ thread_get_priority (void)
   return thread_current ()->priority;
 }
 
+/* Returns true if thread A has higher priority than thread B,
+   given the `elem' members of each.  Orders the run queue and
+   semaphore wait queues. */
+bool
+thread_higher_priority (const struct heap_elem *a_,
+                        const struct heap_elem *b_, void *aux UNUSED)
+{
+  const struct thread *a = heap_entry (a_, struct thread, elem);
+  const struct thread *b = heap_entry (b_, struct thread, elem);
+
+  return a->priority > b->priority;
+}
+
 /* Sets the current thread's nice value to NICE. */
 void
 thread_set_nice (int nice UNUSED) 
@@ -406,6 +421,16 @@ idle (void *idle_started_ UNUSED)
       intr_disable ();
       thread_block ();
 
+      /* Nothing else is ready, so spend the time zeroing free
+         pages for later PAL_ZERO allocations, a page at a time,
+         until there are none left or another thread wakes up. */
+      intr_enable ();
+      while (heap_empty (&ready_queue) && palloc_zero_idle_page ())
+        continue;
+      intr_disable ();
+      if (!heap_empty (&ready_queue))
+        continue;
+
       /* Re-enable interrupts and wait for the next one.
 
          The `sti' instruction disables interrupts until the
@@ -471,6 +496,10 @@ init_thread (struct thread *t, const char *name, int priority)
   t->stack = (uint8_t *) t + PGSIZE;
   t->priority = priority;
   t->magic = THREAD_MAGIC;
+#ifdef USERPROG
+  list_init (&t->children);
+  list_init (&t->shm_maps);
+#endif
 
   //t->is_kernel = is_kernel;
 
@@ -501,10 +530,10 @@ alloc_frame (struct thread *t, size_t size)
 static struct thread *
 next_thread_to_run (void) 
 {
-  if (list_empty (&ready_list))
+  if (heap_empty (&ready_queue))
     return idle_thread;
   else
-    return list_entry (list_pop_front (&ready_list), struct thread, elem);
+    return heap_entry (heap_pop (&ready_queue), struct thread, elem);
 }
 
 /* Completes a thread switch by activating the new thread's page
@@ -572,7 +601,10 @@ schedule (void)
   ASSERT (is_thread (next));
 
   if (cur != next)
-    prev = switch_threads (cur, next);
+    {
+      TRACE (TRACE_THREAD_SWITCH, cur->tid, next->tid, 0);
+      prev = switch_threads (cur, next);
+    }
   thread_schedule_tail (prev);
 }
 
@@ -2,6 +2,7 @@
 #define THREADS_THREAD_H
 
 #include <debug.h>
+#include <heap.h>
 #include <list.h>
 #include <stdint.h>
 
@@ -74,12 +75,16 @@ typedef int tid_t;
    the `magic' member of the running thread's `struct thread' is
    set to THREAD_MAGIC.  Stack overflow will normally change this
    value, triggering the assertion. */
-/* The `elem' member has a dual purpose.  It can be an element in
-   the run queue (thread.c), or it can be an element in a
-   semaphore wait list (synch.c).  It can be used these two ways
-   only because they are mutually exclusive: only a thread in the
-   ready state is on the run queue, whereas only a thread in the
-   blocked state is on a semaphore wait list. */
+/* The `elem' member has several purposes.  It can be an element
+   in the run queue (thread.c), in a semaphore wait queue
+   (synch.c), or in the queue of sleeping threads (timer.c).  It
+   can be used these ways only because they are mutually
+   exclusive: only a thread in the ready state is on the run
+   queue, whereas only a thread in the blocked state is on a
+   semaphore wait queue or asleep, and never both at once.  The
+   run queue and semaphore wait queues are heaps ordered by
+   thread_higher_priority(); the sleep queue is ordered by wakeup
+   time. */
 struct thread
   {
     /* Owned by thread.c. */
@@ -92,16 +97,23 @@ struct thread
     int exit_code;                       /* Stores exit code CMG */
 		
 
-    /* Shared between thread.c and synch.c. */
-    struct list_elem elem;              /* List element. */
+    /* Shared between thread.c, synch.c and timer.c. */
+    struct heap_elem elem;              /* Heap element. */
+
+    /* Owned by devices/timer.c. */
+    int64_t wakeup_tick;                /* Tick to wake at, if sleeping. */
       
 #ifdef USERPROG
     /* Owned by userprog/process.c. */
     uint32_t *pagedir;                  /* Page directory. */
-    struct thread *parent; //Stores parent thread
-    struct list children; //Stores child process list
+    struct wait_status *wait_status;    /* This process's completion status. */
+    struct list children;               /* Completion status of children. */
     char *filename; //Stores the filename the thread is executing
-    bool is_waiting; //True if the current thread is waiting
+    void *user_esp;                     /* User esp saved on syscall entry. */
+    size_t stack_pages;                 /* Pages in the user stack. */
+    struct fdtable *fds;                /* Open file descriptors. */
+    struct sq_ring *ring;               /* System call ring, if mapped. */
+    struct list shm_maps;               /* Attached shared pages. */
 #endif
 
     /* Owned by thread.c. */
@@ -138,6 +150,8 @@ void thread_foreach (thread_action_func *, void *);
 
 int thread_get_priority (void);
 void thread_set_priority (int);
+bool thread_higher_priority (const struct heap_elem *,
+                             const struct heap_elem *, void *aux);
 
 int thread_get_nice (void);
 void thread_set_nice (int);
@@ -4,6 +4,9 @@
 #include "userprog/gdt.h"
 #include "threads/interrupt.h"
 #include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/process.h"
+#include "userprog/usermem.h"
 
 /* Number of page faults processed. */
 static long long page_fault_cnt;
@@ -148,6 +151,23 @@ page_fault (struct intr_frame *f)
   write = (f->error_code & PF_W) != 0;
   user = (f->error_code & PF_U) != 0;
 
+  /* A not-present fault just below the user stack pointer is the
+     stack growing.  A fault raised by the kernel while servicing
+     a system call is judged against the user esp saved on entry
+     to the system call, since F->esp is then a kernel address. */
+  if (not_present && is_user_vaddr (fault_addr))
+    {
+      void *esp = user ? f->esp : thread_current ()->user_esp;
+      if (process_grow_stack (fault_addr, esp))
+        return;
+    }
+
+  /* A kernel access to a bad user address from one of the user
+     memory accessors in usermem.c resumes at its recovery point,
+     which reports the error to the caller. */
+  if (!user && is_user_vaddr (fault_addr) && usermem_fixup (f))
+    return;
+
   /* To implement virtual memory, delete the rest of the function
      body, and replace it with code that brings in the page to
      which fault_addr refers. */
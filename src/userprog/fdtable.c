@@ -0,0 +1,230 @@
+#include "userprog/fdtable.h"
+#include <debug.h>
+#include <stddef.h>
+#include "filesys/file.h"
+#include "threads/malloc.h"
+#include "userprog/pipe.h"
+
+/* Kinds of object a descriptor may refer to. */
+enum fd_type
+  {
+    FD_NONE,                    /* Slot is free. */
+    FD_FILE,                    /* An open file. */
+    FD_PIPE_READ,               /* The read end of a pipe. */
+    FD_PIPE_WRITE               /* The write end of a pipe. */
+  };
+
+/* An open descriptor. */
+struct fd_entry
+  {
+    enum fd_type type;          /* Kind of object. */
+    union
+      {
+        struct file *file;      /* FD_FILE. */
+        struct pipe *pipe;      /* FD_PIPE_READ, FD_PIPE_WRITE. */
+      };
+  };
+
+/* A per-process table of open descriptors.
+
+   Descriptor FD refers to slot FD - FD_MIN of ENTRIES.  Unused
+   slots are chained through NEXT_FREE into a free list headed
+   by FREE_HEAD, so that lookup, insertion and removal are all
+   O(1).  Freed slots are reused most-recently-freed first. */
+struct fdtable
+  {
+    struct fd_entry entries[FD_TABLE_SIZE]; /* Open descriptors. */
+    int next_free[FD_TABLE_SIZE];           /* Free list links. */
+    int free_head;                          /* First free slot, or -1. */
+  };
+
+/* Returns the table slot for FD, or -1 if FD is out of range. */
+static inline int
+fd_to_slot (int fd)
+{
+  return fd >= FD_MIN && fd < FD_MIN + FD_TABLE_SIZE ? fd - FD_MIN : -1;
+}
+
+/* Returns the descriptor type for an end of a pipe. */
+static inline enum fd_type
+pipe_type (bool writer)
+{
+  return writer ? FD_PIPE_WRITE : FD_PIPE_READ;
+}
+
+/* Chains every free slot in T into its free list, lowest
+   first. */
+static void
+rebuild_free_list (struct fdtable *t)
+{
+  int i;
+
+  t->free_head = -1;
+  for (i = FD_TABLE_SIZE - 1; i >= 0; i--)
+    if (t->entries[i].type == FD_NONE)
+      {
+        t->next_free[i] = t->free_head;
+        t->free_head = i;
+      }
+}
+
+/* Creates and returns an empty file descriptor table, or a null
+   pointer if memory allocation fails. */
+struct fdtable *
+fdtable_create (void)
+{
+  struct fdtable *t = malloc (sizeof *t);
+  int i;
+
+  if (t == NULL)
+    return NULL;
+
+  for (i = 0; i < FD_TABLE_SIZE; i++)
+    t->entries[i].type = FD_NONE;
+  rebuild_free_list (t);
+  return t;
+}
+
+/* Closes the object that entry E refers to and marks E free. */
+static void
+close_entry (struct fd_entry *e)
+{
+  switch (e->type)
+    {
+    case FD_NONE:
+      break;
+    case FD_FILE:
+      file_close (e->file);
+      break;
+    case FD_PIPE_READ:
+    case FD_PIPE_WRITE:
+      pipe_close (e->pipe, e->type == FD_PIPE_WRITE);
+      break;
+    }
+  e->type = FD_NONE;
+}
+
+/* Closes every descriptor still open in T and frees T. */
+void
+fdtable_destroy (struct fdtable *t)
+{
+  int i;
+
+  if (t == NULL)
+    return;
+
+  for (i = 0; i < FD_TABLE_SIZE; i++)
+    close_entry (&t->entries[i]);
+  free (t);
+}
+
+/* Gives T, which must be empty, its own reference to each pipe
+   end open in PARENT, under the same descriptor.  This is how a
+   process hands pipes to the children it executes. */
+void
+fdtable_inherit_pipes (struct fdtable *t, const struct fdtable *parent)
+{
+  int i;
+
+  for (i = 0; i < FD_TABLE_SIZE; i++)
+    {
+      const struct fd_entry *e = &parent->entries[i];
+      if (e->type == FD_PIPE_READ || e->type == FD_PIPE_WRITE)
+        {
+          pipe_reopen (e->pipe, e->type == FD_PIPE_WRITE);
+          t->entries[i] = *e;
+        }
+    }
+  rebuild_free_list (t);
+}
+
+/* Adds E to T and returns its new descriptor, or -1 if T is
+   full. */
+static int
+insert_entry (struct fdtable *t, const struct fd_entry *e)
+{
+  int slot = t->free_head;
+  if (slot == -1)
+    return -1;
+
+  t->free_head = t->next_free[slot];
+  t->entries[slot] = *e;
+  return slot + FD_MIN;
+}
+
+/* Adds FILE to T and returns its new descriptor, or -1 if T is
+   full.  T takes ownership of FILE only on success. */
+int
+fdtable_insert (struct fdtable *t, struct file *file)
+{
+  struct fd_entry e;
+
+  ASSERT (file != NULL);
+
+  e.type = FD_FILE;
+  e.file = file;
+  return insert_entry (t, &e);
+}
+
+/* Adds the write end of PIPE to T if WRITER is true, otherwise
+   its read end, and returns the new descriptor, or -1 if T is
+   full.  T takes over the caller's reference to that end only on
+   success. */
+int
+fdtable_insert_pipe (struct fdtable *t, struct pipe *pipe, bool writer)
+{
+  struct fd_entry e;
+
+  ASSERT (pipe != NULL);
+
+  e.type = pipe_type (writer);
+  e.pipe = pipe;
+  return insert_entry (t, &e);
+}
+
+/* Returns the entry for FD in T, or a null pointer if FD is not
+   open. */
+static struct fd_entry *
+lookup_entry (struct fdtable *t, int fd)
+{
+  int slot = fd_to_slot (fd);
+  return slot != -1 && t->entries[slot].type != FD_NONE
+         ? &t->entries[slot] : NULL;
+}
+
+/* Returns the file open as FD in T, or a null pointer if FD is
+   not an open file. */
+struct file *
+fdtable_lookup (struct fdtable *t, int fd)
+{
+  struct fd_entry *e = lookup_entry (t, fd);
+  return e != NULL && e->type == FD_FILE ? e->file : NULL;
+}
+
+/* Returns the pipe whose write end (if WRITER is true) or read
+   end (otherwise) is open as FD in T, or a null pointer if FD is
+   not such a pipe end. */
+struct pipe *
+fdtable_lookup_pipe (struct fdtable *t, int fd, bool writer)
+{
+  struct fd_entry *e = lookup_entry (t, fd);
+  return e != NULL && e->type == pipe_type (writer) ? e->pipe : NULL;
+}
+
+/* Closes FD in T.  Returns true if successful, false if FD was
+   not open. */
+bool
+fdtable_close (struct fdtable *t, int fd)
+{
+  struct fd_entry *e = lookup_entry (t, fd);
+  int slot;
+
+  if (e == NULL)
+    return false;
+
+  close_entry (e);
+  slot = fd - FD_MIN;
+  t->next_free[slot] = t->free_head;
+  t->free_head = slot;
+  return true;
+}
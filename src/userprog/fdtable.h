@@ -0,0 +1,23 @@
+#ifndef USERPROG_FDTABLE_H
+#define USERPROG_FDTABLE_H
+
+#include <stdbool.h>
+
+struct file;
+struct pipe;
+
+/* File descriptors 0 and 1 are the console; table entries start
+   at FD_MIN. */
+#define FD_MIN 2                /* First descriptor handed out. */
+#define FD_TABLE_SIZE 128       /* Open files per process. */
+
+struct fdtable *fdtable_create (void);
+void fdtable_destroy (struct fdtable *);
+void fdtable_inherit_pipes (struct fdtable *, const struct fdtable *parent);
+int fdtable_insert (struct fdtable *, struct file *);
+int fdtable_insert_pipe (struct fdtable *, struct pipe *, bool writer);
+struct file *fdtable_lookup (struct fdtable *, int fd);
+struct pipe *fdtable_lookup_pipe (struct fdtable *, int fd, bool writer);
+bool fdtable_close (struct fdtable *, int fd);
+
+#endif /* userprog/fdtable.h */
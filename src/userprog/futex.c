@@ -0,0 +1,142 @@
+#include "userprog/futex.h"
+#include <debug.h>
+#include <hash.h>
+#include <list.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/pagedir.h"
+#include "userprog/shm.h"
+#include "userprog/usermem.h"
+
+/* Number of wait queue buckets.  Must be a power of 2. */
+#define FUTEX_BUCKETS 64
+
+/* A hash bucket of futex wait queues.  Waiters for every futex
+   whose key hashes here share one list. */
+struct futex_bucket
+  {
+    struct lock lock;           /* Protects waiters. */
+    struct list waiters;        /* List of struct futex_waiter. */
+  };
+
+/* A thread sleeping in futex_wait(). */
+struct futex_waiter
+  {
+    struct list_elem elem;      /* Element in bucket's waiters. */
+    uintptr_t key;              /* Futex being waited on. */
+    struct semaphore sema;      /* Upped to wake the waiter. */
+  };
+
+static struct futex_bucket buckets[FUTEX_BUCKETS];
+
+/* Initializes the futex wait queues. */
+void
+futex_init (void)
+{
+  size_t i;
+
+  for (i = 0; i < FUTEX_BUCKETS; i++)
+    {
+      lock_init (&buckets[i].lock);
+      list_init (&buckets[i].waiters);
+    }
+}
+
+/* Returns the key for the futex at user address UADDR in the
+   running process: the kernel virtual address of the int in its
+   frame, which identifies the frame plus offset.  Returns 0 if
+   UADDR is misaligned or not mapped. */
+static uintptr_t
+futex_key (int *uaddr)
+{
+  if ((uintptr_t) uaddr % sizeof *uaddr != 0)
+    return 0;
+  return (uintptr_t) pagedir_get_page (thread_current ()->pagedir, uaddr);
+}
+
+/* Returns the bucket for futex KEY. */
+static struct futex_bucket *
+futex_bucket (uintptr_t key)
+{
+  return &buckets[hash_int (key / sizeof (int)) & (FUTEX_BUCKETS - 1)];
+}
+
+/* Returns true if a thread other than the running one may be
+   able to reach the futex with KEY, and so could wake a waiter
+   on it.  Every process has one thread, so that is the case
+   just when the futex is in a shared memory page. */
+static bool
+futex_shared (uintptr_t key)
+{
+  return shm_is_shared (pg_round_down ((void *) key));
+}
+
+/* If the int at user address UADDR equals VAL, sleeps until a
+   futex_wake() on the same futex wakes us and returns 0.
+   Otherwise returns -1 at once.  The comparison and going to
+   sleep are atomic with respect to futex_wake(), so a wakeup
+   that follows a change to the value cannot be missed.  Also
+   returns -1 if UADDR is not an aligned, mapped user address,
+   or if no other thread could ever wake us. */
+int
+futex_wait (int *uaddr, int val)
+{
+  struct futex_waiter waiter;
+  struct futex_bucket *b;
+  int cur;
+
+  waiter.key = futex_key (uaddr);
+  if (waiter.key == 0)
+    return -1;
+  b = futex_bucket (waiter.key);
+
+  lock_acquire (&b->lock);
+  if (!copy_from_user (&cur, uaddr, sizeof cur) || cur != val
+      || !futex_shared (waiter.key))
+    {
+      lock_release (&b->lock);
+      return -1;
+    }
+  sema_init (&waiter.sema, 0);
+  list_push_back (&b->waiters, &waiter.elem);
+  lock_release (&b->lock);
+
+  sema_down (&waiter.sema);
+  return 0;
+}
+
+/* Wakes up to CNT threads waiting on the futex at user address
+   UADDR, oldest first.  Returns the number woken, or -1 if UADDR
+   is not an aligned, mapped user address. */
+int
+futex_wake (int *uaddr, int cnt)
+{
+  uintptr_t key = futex_key (uaddr);
+  struct futex_bucket *b;
+  struct list_elem *e;
+  int woken = 0;
+
+  if (key == 0)
+    return -1;
+  b = futex_bucket (key);
+
+  lock_acquire (&b->lock);
+  for (e = list_begin (&b->waiters);
+       e != list_end (&b->waiters) && woken < cnt; )
+    {
+      struct futex_waiter *w = list_entry (e, struct futex_waiter, elem);
+      if (w->key == key)
+        {
+          e = list_remove (e);
+          sema_up (&w->sema);
+          woken++;
+        }
+      else
+        e = list_next (e);
+    }
+  lock_release (&b->lock);
+  return woken;
+}
@@ -0,0 +1,23 @@
+#ifndef USERPROG_FUTEX_H
+#define USERPROG_FUTEX_H
+
+/* Fast user-space locking.
+
+   A futex is an aligned int in user memory.  User code
+   manipulates it with atomic instructions and enters the kernel
+   only to sleep until the value changes or to wake sleepers.
+   Waiters are keyed by the physical location of the int, so
+   any mappings of the same frame name the same futex.
+
+   Every process has a single thread, so only another process
+   could wake a waiter, and it can reach only futexes in pages
+   shared with shm_attach().  futex_wait() on any other memory
+   fails at once instead of sleeping forever; user-level mutexes
+   and condition variables there degrade to spinning and
+   spurious wakeups. */
+
+void futex_init (void);
+int futex_wait (int *uaddr, int val);
+int futex_wake (int *uaddr, int cnt);
+
+#endif /* userprog/futex.h */
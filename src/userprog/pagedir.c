@@ -5,9 +5,38 @@
 #include "threads/init.h"
 #include "threads/pte.h"
 #include "threads/palloc.h"
+#include "threads/synch.h"
+
+/* Ranges of up to this many pages are flushed from the TLB one
+   page at a time.  Flushing a larger range reloads CR3 instead,
+   discarding every non-global translation at once, which is
+   cheaper than a long run of invlpg instructions. */
+#define INVLPG_MAX 32
+
+/* Number of zeroed pages kept for reuse as page tables and
+   page directories. */
+#define PT_POOL_SIZE 16
+
+/* Pool of all-zero pages.  pagedir_destroy() clears each page
+   table as it frees the pages it maps, so keeping the cleared
+   table here instead of returning it to palloc saves zeroing a
+   fresh page the next time one is needed. */
+static void *pt_pool[PT_POOL_SIZE];
+static size_t pt_pool_cnt;
+static struct lock pt_pool_lock;
 
 static uint32_t *active_pd (void);
+static void invalidate_page (uint32_t *, const void *);
 static void invalidate_pagedir (uint32_t *);
+static void *get_zeroed_page (void);
+static void put_zeroed_page (void *);
+
+/* Initializes the page directory module. */
+void
+pagedir_init (void) 
+{
+  lock_init (&pt_pool_lock);
+}
 
 /* Creates a new page directory that has mappings for kernel
    virtual addresses, but none for user virtual addresses.
@@ -16,9 +45,11 @@ static void invalidate_pagedir (uint32_t *);
 uint32_t *
 pagedir_create (void) 
 {
-  uint32_t *pd = palloc_get_page (0);
+  size_t kernel_pde = pd_no (PHYS_BASE);
+  uint32_t *pd = get_zeroed_page ();
   if (pd != NULL)
-    memcpy (pd, init_page_dir, PGSIZE);
+    memcpy (pd + kernel_pde, init_page_dir + kernel_pde,
+            PGSIZE - kernel_pde * sizeof *pd);
   return pd;
 }
 
@@ -40,11 +71,19 @@ pagedir_destroy (uint32_t *pd)
         uint32_t *pte;
         
         for (pte = pt; pte < pt + PGSIZE / sizeof *pte; pte++)
-          if (*pte & PTE_P) 
-            palloc_free_page (pte_get_page (*pte));
-        palloc_free_page (pt);
+          {
+            if (*pte & PTE_P) 
+              palloc_free_page (pte_get_page (*pte));
+            *pte = 0;
+          }
+        put_zeroed_page (pt);
+        *pde = 0;
       }
-  palloc_free_page (pd);
+
+  /* The user half of PD is now zero.  Clear the kernel half too
+     so that PD can go back into the pool. */
+  memset (pde, 0, PGSIZE - pd_no (PHYS_BASE) * sizeof *pd);
+  put_zeroed_page (pd);
 }
 
 /* Returns the address of the page table entry for virtual
@@ -70,7 +109,7 @@ lookup_page (uint32_t *pd, const void *vaddr, bool create)
     {
       if (create)
         {
-          pt = palloc_get_page (PAL_ZERO);
+          pt = get_zeroed_page ();
           if (pt == NULL) 
             return NULL; 
       
@@ -152,10 +191,58 @@ pagedir_clear_page (uint32_t *pd, void *upage)
   if (pte != NULL && (*pte & PTE_P) != 0)
     {
       *pte &= ~PTE_P;
-      invalidate_pagedir (pd);
+      invalidate_page (pd, upage);
     }
 }
 
+/* Marks the PAGE_CNT user virtual pages starting at UPAGE "not
+   present" in page directory PD, as pagedir_clear_page() does
+   for each of them, but invalidates the TLB only once, after all
+   of them have been cleared.  Pages in the range need not be
+   mapped. */
+void
+pagedir_clear_range (uint32_t *pd, void *upage, size_t page_cnt)
+{
+  uint8_t *start = upage;
+  uint8_t *end = start + page_cnt * PGSIZE;
+  uint8_t *p;
+  bool cleared = false;
+
+  ASSERT (pg_ofs (upage) == 0);
+  ASSERT (is_user_vaddr (upage));
+  ASSERT (page_cnt <= (size_t) ((uint8_t *) PHYS_BASE - start) / PGSIZE);
+
+  for (p = start; p < end; )
+    {
+      uint32_t *pde = pd + pd_no (p);
+      uint32_t *pt, *pte;
+
+      /* Skip the whole 4 MB covered by a missing page table. */
+      if ((*pde & PTE_P) == 0)
+        {
+          p = (uint8_t *) ((uintptr_t) (pd_no (p) + 1) << PDSHIFT);
+          continue;
+        }
+
+      pt = pde_get_pt (*pde);
+      for (pte = pt + pt_no (p); pte < pt + PGSIZE / sizeof *pte && p < end;
+           pte++, p += PGSIZE)
+        if (*pte & PTE_P)
+          {
+            *pte &= ~PTE_P;
+            cleared = true;
+          }
+    }
+
+  if (!cleared || active_pd () != pd)
+    return;
+  if (page_cnt <= INVLPG_MAX)
+    for (p = start; p < end; p += PGSIZE)
+      invalidate_page (pd, p);
+  else
+    invalidate_pagedir (pd);
+}
+
 /* Returns true if the PTE for virtual page VPAGE in PD is dirty,
    that is, if the page has been modified since the PTE was
    installed.
@@ -180,7 +267,7 @@ pagedir_set_dirty (uint32_t *pd, const void *vpage, bool dirty)
       else 
         {
           *pte &= ~(uint32_t) PTE_D;
-          invalidate_pagedir (pd);
+          invalidate_page (pd, vpage);
         }
     }
 }
@@ -209,7 +296,7 @@ pagedir_set_accessed (uint32_t *pd, const void *vpage, bool accessed)
       else 
         {
           *pte &= ~(uint32_t) PTE_A; 
-          invalidate_pagedir (pd);
+          invalidate_page (pd, vpage);
         }
     }
 }
@@ -243,14 +330,15 @@ active_pd (void)
   return ptov (pd);
 }
 
-/* Seom page table changes can cause the CPU's translation
+/* Some page table changes can cause the CPU's translation
    lookaside buffer (TLB) to become out-of-sync with the page
    table.  When this happens, we have to "invalidate" the TLB by
    re-activating it.
 
    This function invalidates the TLB if PD is the active page
    directory.  (If PD is not active then its entries are not in
-   the TLB, so there is no need to invalidate anything.) */
+   the TLB, so there is no need to invalidate anything.)  Prefer
+   invalidate_page() when only one page changed. */
 static void
 invalidate_pagedir (uint32_t *pd) 
 {
@@ -261,3 +349,47 @@ invalidate_pagedir (uint32_t *pd)
       pagedir_activate (pd);
     } 
 }
+
+/* Invalidates the TLB entry for virtual page VPAGE, if PD is the
+   active page directory.  Unlike invalidate_pagedir(), this
+   leaves every other translation in the TLB.  See [IA32-v2a]
+   "INVLPG--Invalidate TLB Entry". */
+static void
+invalidate_page (uint32_t *pd, const void *vpage)
+{
+  if (active_pd () == pd)
+    asm volatile ("invlpg (%0)" : : "r" (vpage) : "memory");
+}
+
+/* Returns an all-zero page from the pool, or from the kernel
+   pool if the pool is empty.  Returns a null pointer if no
+   memory is available. */
+static void *
+get_zeroed_page (void) 
+{
+  void *page = NULL;
+
+  lock_acquire (&pt_pool_lock);
+  if (pt_pool_cnt > 0)
+    page = pt_pool[--pt_pool_cnt];
+  lock_release (&pt_pool_lock);
+
+  return page != NULL ? page : palloc_get_page (PAL_ZERO);
+}
+
+/* Frees PAGE, which must be all zeros, keeping it in the pool if
+   there is room. */
+static void
+put_zeroed_page (void *page) 
+{
+  lock_acquire (&pt_pool_lock);
+  if (pt_pool_cnt < PT_POOL_SIZE)
+    {
+      pt_pool[pt_pool_cnt++] = page;
+      page = NULL;
+    }
+  lock_release (&pt_pool_lock);
+
+  if (page != NULL)
+    palloc_free_page (page);
+}
@@ -0,0 +1,246 @@
+#include "userprog/pipe.h"
+#include <debug.h>
+#include <stdint.h>
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/pagedir.h"
+#include "userprog/shm.h"
+#include "userprog/usermem.h"
+
+/* Bytes of data a pipe can hold. */
+#define PIPE_SIZE (PIPE_PAGES * PGSIZE)
+
+/* A pipe: a byte stream from writers to readers through a ring
+   of kernel pages.
+
+   Data is copied straight between user memory and the ring,
+   with no intermediate buffer.  Better still, when a reader
+   asks for a whole page of data into a page-aligned buffer and
+   the ring holds a whole page at a page boundary, the reader's
+   frame and the ring's page simply trade places in the reader's
+   page table, so the data is not copied out at all. */
+struct pipe
+  {
+    struct lock lock;           /* Protects all members. */
+    struct condition readable;  /* Signaled on new data or no writers. */
+    struct condition writable;  /* Signaled on free space or no readers. */
+    uint8_t *pages[PIPE_PAGES]; /* Ring of buffer pages. */
+    size_t head;                /* Ring offset of the oldest byte. */
+    size_t used;                /* Bytes of data in the ring. */
+    int reader_cnt;             /* Open read ends. */
+    int writer_cnt;             /* Open write ends. */
+  };
+
+static void free_pipe (struct pipe *);
+
+/* Creates a pipe with one read end and one write end open.
+   Returns the pipe, or a null pointer if memory is short. */
+struct pipe *
+pipe_create (void)
+{
+  struct pipe *p = calloc (1, sizeof *p);
+  size_t i;
+
+  if (p == NULL)
+    return NULL;
+
+  /* Ring pages come from the user pool, since they may be handed
+     over to a reader's address space. */
+  for (i = 0; i < PIPE_PAGES; i++)
+    {
+      p->pages[i] = palloc_get_page (PAL_USER);
+      if (p->pages[i] == NULL)
+        {
+          free_pipe (p);
+          return NULL;
+        }
+    }
+
+  lock_init (&p->lock);
+  cond_init (&p->readable);
+  cond_init (&p->writable);
+  p->reader_cnt = p->writer_cnt = 1;
+  return p;
+}
+
+/* Frees P and its pages. */
+static void
+free_pipe (struct pipe *p)
+{
+  size_t i;
+
+  for (i = 0; i < PIPE_PAGES; i++)
+    if (p->pages[i] != NULL)
+      palloc_free_page (p->pages[i]);
+  free (p);
+}
+
+/* Opens another reference to the write end of P if WRITER is
+   true, otherwise to its read end. */
+void
+pipe_reopen (struct pipe *p, bool writer)
+{
+  lock_acquire (&p->lock);
+  if (writer)
+    p->writer_cnt++;
+  else
+    p->reader_cnt++;
+  lock_release (&p->lock);
+}
+
+/* Closes a reference to the write end of P if WRITER is true,
+   otherwise to its read end.  Frees P once both ends are
+   completely closed. */
+void
+pipe_close (struct pipe *p, bool writer)
+{
+  bool dead;
+
+  if (p == NULL)
+    return;
+
+  lock_acquire (&p->lock);
+  if (writer)
+    {
+      ASSERT (p->writer_cnt > 0);
+      if (--p->writer_cnt == 0)
+        cond_broadcast (&p->readable, &p->lock);
+    }
+  else
+    {
+      ASSERT (p->reader_cnt > 0);
+      if (--p->reader_cnt == 0)
+        cond_broadcast (&p->writable, &p->lock);
+    }
+  dead = p->reader_cnt == 0 && p->writer_cnt == 0;
+  lock_release (&p->lock);
+
+  if (dead)
+    free_pipe (p);
+}
+
+/* Tries to move the page of data at the head of P into the
+   running process at page-aligned user address UPAGE by
+   swapping it with the frame already mapped there.  P's lock
+   must be held and the head of P must be a whole page.  Returns
+   true if successful.
+
+   Fails for the system call ring's page, because the kernel
+   keeps its own pointer to that frame: after a swap the kernel
+   would go on using a page that the pipe owns and later frees.
+   Fails for a shared memory page too, which must stay the same
+   frame in every process that attaches it. */
+static bool
+flip_page (struct pipe *p, uint8_t *upage)
+{
+  struct thread *t = thread_current ();
+  uint32_t *pd = t->pagedir;
+  size_t slot = p->head / PGSIZE;
+  uint8_t *kpage = pagedir_get_page (pd, upage);
+
+  if (kpage == NULL || kpage == (uint8_t *) t->ring
+      || shm_is_shared (kpage))
+    return false;
+
+  /* Clearing the old mapping first flushes it from the TLB. */
+  pagedir_clear_page (pd, upage);
+  if (!pagedir_set_page (pd, upage, p->pages[slot], true))
+    {
+      pagedir_set_page (pd, upage, kpage, true);
+      return false;
+    }
+  p->pages[slot] = kpage;
+  return true;
+}
+
+/* Reads up to SIZE bytes from P into user buffer UBUF, which the
+   caller has checked is writable.  Sleeps until at least one
+   byte is available or every write end is closed.  Returns the
+   number of bytes read, which is 0 at end of file, or -1 if a
+   user access fails. */
+int
+pipe_read (struct pipe *p, void *ubuf, size_t size)
+{
+  uint8_t *dst = ubuf;
+  size_t read = 0;
+  bool ok = true;
+
+  lock_acquire (&p->lock);
+  while (p->used == 0 && p->writer_cnt > 0 && size > 0)
+    cond_wait (&p->readable, &p->lock);
+
+  while (read < size && p->used > 0)
+    {
+      size_t ofs = p->head % PGSIZE;
+      size_t chunk = PGSIZE - ofs;
+      bool flipped;
+
+      if (chunk > p->used)
+        chunk = p->used;
+      if (chunk > size - read)
+        chunk = size - read;
+
+      flipped = (chunk == PGSIZE && pg_ofs (dst + read) == 0
+                 && flip_page (p, dst + read));
+      if (!flipped
+          && !copy_to_user (dst + read, p->pages[p->head / PGSIZE] + ofs,
+                            chunk))
+        {
+          ok = false;
+          break;
+        }
+
+      p->head = (p->head + chunk) % PIPE_SIZE;
+      p->used -= chunk;
+      read += chunk;
+    }
+  if (read > 0)
+    cond_broadcast (&p->writable, &p->lock);
+  lock_release (&p->lock);
+
+  return read > 0 || ok ? (int) read : -1;
+}
+
+/* Writes SIZE bytes from user buffer UBUF, which the caller has
+   checked is readable, to P, sleeping while P is full.  Returns
+   the number of bytes written, which is less than SIZE only if
+   every read end is closed partway through, or -1 if no reader
+   is left to see any of the data or a user access fails. */
+int
+pipe_write (struct pipe *p, const void *ubuf, size_t size)
+{
+  const uint8_t *src = ubuf;
+  size_t written = 0;
+
+  lock_acquire (&p->lock);
+  while (written < size)
+    {
+      size_t tail, ofs, chunk;
+
+      while (p->used == PIPE_SIZE && p->reader_cnt > 0)
+        cond_wait (&p->writable, &p->lock);
+      if (p->reader_cnt == 0)
+        break;
+
+      tail = (p->head + p->used) % PIPE_SIZE;
+      ofs = tail % PGSIZE;
+      chunk = PGSIZE - ofs;
+      if (chunk > PIPE_SIZE - p->used)
+        chunk = PIPE_SIZE - p->used;
+      if (chunk > size - written)
+        chunk = size - written;
+
+      if (!copy_from_user (p->pages[tail / PGSIZE] + ofs, src + written,
+                           chunk))
+        break;
+      p->used += chunk;
+      written += chunk;
+      cond_broadcast (&p->readable, &p->lock);
+    }
+  lock_release (&p->lock);
+
+  return written > 0 || size == 0 ? (int) written : -1;
+}
@@ -0,0 +1,16 @@
+#ifndef USERPROG_PIPE_H
+#define USERPROG_PIPE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Capacity of a pipe, in pages. */
+#define PIPE_PAGES 4
+
+struct pipe *pipe_create (void);
+void pipe_reopen (struct pipe *, bool writer);
+void pipe_close (struct pipe *, bool writer);
+int pipe_read (struct pipe *, void *ubuf, size_t size);
+int pipe_write (struct pipe *, const void *ubuf, size_t size);
+
+#endif /* userprog/pipe.h */
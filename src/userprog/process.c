@@ -5,38 +5,82 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <trace.h>
+#include "userprog/fdtable.h"
 #include "userprog/gdt.h"
 #include "userprog/pagedir.h"
+#include "userprog/shm.h"
 #include "userprog/tss.h"
 #include "filesys/directory.h"
 #include "filesys/file.h"
 #include "filesys/filesys.h"
+#include "filesys/inode.h"
 #include "threads/flags.h"
 #include "threads/init.h"
 #include "threads/interrupt.h"
+#include "threads/malloc.h"
 #include "threads/palloc.h"
 #include "threads/thread.h"
 #include "threads/vaddr.h"
 #include "threads/synch.h"
 
+/* Maximum size of each process's user stack, in pages. */
+size_t process_stack_limit = STACK_MAX_PAGES;
+
+/* Statistics. */
+static long long stack_grow_cnt;    /* # of stack pages added on demand. */
+static size_t stack_peak_pages;     /* Largest stack seen, in pages. */
+static long long image_hit_cnt;     /* # of execs served by image cache. */
+static long long image_miss_cnt;    /* # of execs that parsed headers. */
+
+/* Completion status of a child process, shared between the
+   child and its parent so that the exit code outlives whichever
+   of the two threads dies first.  Freed when both have dropped
+   their reference. */
+struct wait_status
+  {
+    struct list_elem elem;              /* Element in parent's `children'. */
+    struct lock lock;                   /* Protects ref_cnt. */
+    int ref_cnt;                        /* 2=both alive, 1=one alive. */
+    tid_t tid;                          /* Child thread id. */
+    int exit_code;                      /* Child exit code, once dead. */
+    struct semaphore dead;              /* Upped when the child exits. */
+  };
+
+/* Data handed from process_execute() to start_process(). */
+struct exec_info
+  {
+    char *cmdline;                      /* Command line to run. */
+    struct semaphore load_done;         /* Upped when loading finishes. */
+    struct wait_status *wait_status;    /* Child's completion status. */
+    struct fdtable *parent_fds;         /* Parent's descriptors, if any. */
+    bool success;                       /* Whether the program loaded. */
+  };
+
 //Functions
 static thread_func start_process NO_RETURN;
 static bool load (const char *cmdline, void (**eip) (void), void **esp);
+static bool install_page (void *upage, void *kpage, bool writable);
+static void release_wait_status (struct wait_status *);
+static size_t program_name (char *name, size_t size, const char *cmdline);
 
 /* Starts a new thread running a user program loaded from
-   FILENAME.  The new thread may be scheduled (and may even exit)
-   before process_execute() returns.  Returns the new process's
-   thread id, or TID_ERROR if the thread cannot be created. */
+   FILENAME.  Waits until the new process has finished loading,
+   then records it as a child of the running process.  The new
+   process inherits the running process's pipe descriptors.  Returns
+   the new process's thread id, or TID_ERROR if the thread cannot
+   be created or the program cannot be loaded. */
 
 tid_t
 process_execute (const char *cmdline) 
 {
+  struct exec_info exec;
+  struct wait_status *ws;
   char *cmd_copy;
   tid_t tid;
-  char *filename;
-  char *save_ptr = NULL;
+  char name[16];
 
-  /* Make a copy of FILE_NAME.
+  /* Make a copy of CMDLINE.
      Otherwise there's a race between the caller and load(). */
 
   cmd_copy = palloc_get_page (0);
@@ -45,34 +89,66 @@ process_execute (const char *cmdline)
  
   strlcpy (cmd_copy, cmdline, PGSIZE);
 
-  //Extract filename from the commmand lne
-  filename = strtok_r(cmd_copy, " ", &save_ptr);
+  //Name the thread after the program, leaving the command line intact
+  program_name (name, sizeof name, cmd_copy);
 
-  //Testing statements
-  printf("Filename: %s\n", filename);
-  printf("Args: %s\n", save_ptr);
+  /* The child holds one reference to its status and we hold the
+     other until it is waited for or we exit. */
+  ws = malloc (sizeof *ws);
+  if (ws == NULL)
+    {
+      palloc_free_page (cmd_copy);
+      return TID_ERROR;
+    }
+  lock_init (&ws->lock);
+  ws->ref_cnt = 2;
+  ws->exit_code = -1;
+  sema_init (&ws->dead, 0);
 
-    /* Create a new thread to execute FILE_NAME. */
-  tid = thread_create (filename, PRI_DEFAULT, start_process, cmd_copy);
+  exec.cmdline = cmd_copy;
+  exec.wait_status = ws;
+  exec.parent_fds = thread_current ()->fds;
+  exec.success = false;
+  sema_init (&exec.load_done, 0);
 
-  if (tid == TID_ERROR)
-    palloc_free_page (cmd_copy);
+    /* Create a new thread to execute FILE_NAME. */
+  tid = thread_create (name, PRI_DEFAULT, start_process, &exec);
+  if (tid != TID_ERROR)
+    {
+      ws->tid = tid;
+      sema_down (&exec.load_done);
+      if (exec.success)
+        {
+          list_push_back (&thread_current ()->children, &ws->elem);
+          TRACE (TRACE_PROCESS_EXEC, tid, 0, 0);
+        }
+      else
+        {
+          release_wait_status (ws);
+          tid = TID_ERROR;
+        }
+    }
+  else
+    free (ws);
 
+  palloc_free_page (cmd_copy);
   return tid;
 }
 
 /* A thread function that loads a user process and starts it
    running. */
 static void
-start_process (void *proc_)
+start_process (void *exec_)
 {
   //Initialize variables and structures
+  struct exec_info *exec = exec_; //Data passed to function
   struct intr_frame if_;
   bool success;
-  char *save_ptr;
   struct thread *th = thread_current();
-  char *cmdline = proc_; //Data passed to function
-  char *filename = strtok_r(cmdline, " ", &save_ptr);
+
+  /* Killed processes report -1 unless exit() says otherwise. */
+  th->exit_code = -1;
+  th->wait_status = exec->wait_status;
 
   /* Initialize interrupt frame and load executable. */
   memset (&if_, 0, sizeof if_);
@@ -80,20 +156,16 @@ start_process (void *proc_)
   if_.cs = SEL_UCSEG;
   if_.eflags = FLAG_IF | FLAG_MBS;
 
-  //Debug
-  printf("Loading file!");
-
-  //Load the file
-  success = load (cmdline, &if_.eip, &if_.esp);
+  //Load the file; load() also pushes the arguments onto the stack
+  th->fds = fdtable_create ();
+  if (th->fds != NULL && exec->parent_fds != NULL)
+    fdtable_inherit_pipes (th->fds, exec->parent_fds);
+  success = th->fds != NULL && load (exec->cmdline, &if_.eip, &if_.esp);
 
-  //If successfully loaded add arguments to the stack and update stack
-  if (success)
-  {
-	printf("File loaded successfully!"); //Debugging
-  }
-  
-  //Free the memory page holding the tokens now they have been passed to stack
-  palloc_free_page(cmdline);
+  /* Let the parent go.  EXEC lives on the parent's stack, so it
+     must not be touched after this. */
+  exec->success = success;
+  sema_up (&exec->load_done);
 
   /* If load failed, quit. */
   if (!success) 
@@ -109,6 +181,36 @@ start_process (void *proc_)
   NOT_REACHED ();
 }
 
+/* Copies the first word of CMDLINE, the program name, into NAME,
+   a buffer of SIZE bytes, truncating it if necessary.  Returns
+   the untruncated length of the program name. */
+static size_t
+program_name (char *name, size_t size, const char *cmdline)
+{
+  size_t len;
+
+  cmdline += strspn (cmdline, " ");
+  len = strcspn (cmdline, " ");
+  if (size > 0)
+    strlcpy (name, cmdline, len + 1 < size ? len + 1 : size);
+  return len;
+}
+
+/* Drops a reference to WS, freeing it once both the parent and
+   the child are done with it. */
+static void
+release_wait_status (struct wait_status *ws)
+{
+  int ref_cnt;
+
+  lock_acquire (&ws->lock);
+  ref_cnt = --ws->ref_cnt;
+  lock_release (&ws->lock);
+
+  if (ref_cnt == 0)
+    free (ws);
+}
+
 /* Waits for thread TID to die and returns its exit status.  If
    it was terminated by the kernel (i.e. killed due to an
    exception), returns -1.  If TID is invalid or if it was not a
@@ -116,24 +218,30 @@ start_process (void *proc_)
    been successfully called for the given TID, returns -1
    immediately, without waiting.
 
-   This function will be implemented in problem 2-2.  For now, it
-   does nothing. */
+   Blocks on the child's semaphore rather than polling, and
+   reaps the child's status record before returning. */
 int
 process_wait (tid_t child_tid) 
 {
-    //Structures and variables
-    int exit_code = 0;
-    
-    //Get current thread
-    struct thread *th = thread_current(); //Finding current thread
-   
-    //Set thread wait status
-    th->is_waiting = true;
-
-    //Setting exit code
-    exit_code = th->exit_code;
-
-    return exit_code; //Return
+  struct thread *cur = thread_current ();
+  struct list_elem *e;
+
+  for (e = list_begin (&cur->children); e != list_end (&cur->children);
+       e = list_next (e))
+    {
+      struct wait_status *ws = list_entry (e, struct wait_status, elem);
+      if (ws->tid == child_tid)
+        {
+          int exit_code;
+
+          list_remove (e);
+          sema_down (&ws->dead);
+          exit_code = ws->exit_code;
+          release_wait_status (ws);
+          return exit_code;
+        }
+    }
+  return -1;
 }
 
 /* Free the current process's resources. */
@@ -141,7 +249,13 @@ void
 process_exit (void)
 {
   struct thread *cur = thread_current ();
+  struct list_elem *e;
   uint32_t *pd;
+
+  /* Close all of the process's open files. */
+  fdtable_destroy (cur->fds);
+  cur->fds = NULL;
+
   /* Cameron Mackay-Grant */
   /* Destroy the current process's page directory and switch back
      to the kernel-only page directory. */
@@ -149,6 +263,13 @@ process_exit (void)
   pd = cur->pagedir;
   if (pd != NULL) 
     {
+      //Print the name and exit_code of the process that exits
+      printf("%s: exit(%d)\n", cur->name, cur->exit_code);
+      TRACE (TRACE_PROCESS_EXIT, cur->exit_code, 0, 0);
+
+      /* Unmap shared pages first, so that their frames are not
+         freed along with the page directory. */
+      shm_detach_all ();
 
       /* Correct ordering here is crucial.  We must set
          cur->pagedir to NULL before switching page directories,
@@ -163,17 +284,23 @@ process_exit (void)
       pagedir_destroy (pd);
     }
 
-  //Giving exit code a value of -1 if it is a NULL value and has not been set
-  //elsewhere
-  if (cur->exit_code == NULL)
-	  cur->exit_code = -1;
-
-  if (cur->exit_code == -1)
-	  printf("Exit code not set\n");
-  
-  //Print the name and exit_code of the process that exits
-  printf("%s: exit(%d)\n", cur->name, cur->exit_code);
+  /* Publish our exit code and wake a waiting parent. */
+  if (cur->wait_status != NULL)
+    {
+      struct wait_status *ws = cur->wait_status;
+      ws->exit_code = cur->exit_code;
+      sema_up (&ws->dead);
+      release_wait_status (ws);
+      cur->wait_status = NULL;
+    }
 
+  /* Orphan our children; they free their own status on exit. */
+  for (e = list_begin (&cur->children); e != list_end (&cur->children); )
+    {
+      struct wait_status *ws = list_entry (e, struct wait_status, elem);
+      e = list_remove (e);
+      release_wait_status (ws);
+    }
 }
 
 /* Sets up the CPU for running user code in the current
@@ -192,6 +319,69 @@ process_activate (void)
   tss_update ();
 }
 
+/* Tries to extend the running process's stack down to cover
+   FAULT_ADDR, a user address that caused a not-present page
+   fault while the user stack pointer was ESP.
+
+   The access is accepted as a stack access if it is no more
+   than 32 bytes below ESP (PUSHA writes 32 bytes below ESP
+   before adjusting it) and lies within the top
+   process_stack_limit pages of user memory.  In that case every
+   page between FAULT_ADDR and the current bottom of the stack is
+   mapped to a fresh zeroed page.
+
+   Returns true if the stack was grown, false if FAULT_ADDR is
+   not a legitimate stack access or memory is exhausted. */
+bool
+process_grow_stack (void *fault_addr, const void *esp)
+{
+  struct thread *t = thread_current ();
+  uint8_t *stack_limit = (uint8_t *) PHYS_BASE - process_stack_limit * PGSIZE;
+  uint8_t *upage = pg_round_down (fault_addr);
+  uint8_t *bottom;
+
+  if (t->pagedir == NULL || esp == NULL
+      || !is_user_vaddr (fault_addr)
+      || (uint8_t *) fault_addr < stack_limit
+      || (uint8_t *) fault_addr + 32 < (const uint8_t *) esp)
+    return false;
+
+  /* Fill in every page between the fault and the current bottom
+     of the stack, so that the stack stays contiguous. */
+  bottom = (uint8_t *) PHYS_BASE - t->stack_pages * PGSIZE;
+  if (upage >= bottom)
+    return false;
+  while (bottom > upage)
+    {
+      uint8_t *kpage = palloc_get_page (PAL_USER | PAL_ZERO);
+
+      bottom -= PGSIZE;
+      if (kpage == NULL)
+        return false;
+      if (!install_page (bottom, kpage, true))
+        {
+          palloc_free_page (kpage);
+          return false;
+        }
+      t->stack_pages++;
+      stack_grow_cnt++;
+    }
+
+  if (t->stack_pages > stack_peak_pages)
+    stack_peak_pages = t->stack_pages;
+  return true;
+}
+
+/* Prints user stack statistics. */
+void
+process_print_stats (void)
+{
+  printf ("Stack: %lld pages grown on demand, %zu pages peak\n",
+          stack_grow_cnt, stack_peak_pages);
+  printf ("Exec: %lld image cache hits, %lld misses\n",
+          image_hit_cnt, image_miss_cnt);
+}
+
 /* We load ELF binaries.  The following definitions are taken
    from the ELF specification, [ELF1], more-or-less verbatim.  */
 
@@ -255,43 +445,74 @@ struct Elf32_Phdr
 #define PF_W 2          /* Writable. */
 #define PF_R 4          /* Readable. */
 
-//Setup stack now passes argument count and args array
-static bool setup_stack (void **esp, int count, char *args[]);
+/* Executable image cache.
+
+   Parsing and validating an executable's ELF headers costs
+   several small reads per exec.  The results are cached here,
+   keyed by the executable's inode sector, so that repeated execs
+   of the same program go straight to loading its segments.
+   Entries are dropped whenever the inode is written or freed. */
+
+#define IMAGE_CACHE_SIZE 16     /* Number of cached images. */
+#define IMAGE_SEGS_MAX 8        /* Loadable segments per image. */
+
+/* A loadable segment, from a validated program header. */
+struct image_segment
+  {
+    uint32_t file_page;         /* Page-aligned file offset. */
+    uint32_t mem_page;          /* Page-aligned user address. */
+    uint32_t read_bytes;        /* Bytes to read from the file. */
+    uint32_t zero_bytes;        /* Bytes to zero after those. */
+    bool writable;              /* Writable by the user process? */
+  };
+
+/* Parsed ELF metadata for an executable. */
+struct image
+  {
+    uint32_t entry;             /* Entry point. */
+    size_t seg_cnt;             /* Number of loadable segments. */
+    struct image_segment segs[IMAGE_SEGS_MAX];
+  };
+
+/* An image cache entry. */
+struct image_entry
+  {
+    struct list_elem elem;      /* Element in image_lru. */
+    bool in_use;                /* Does this entry hold an image? */
+    block_sector_t sector;      /* Inode sector of the executable. */
+    struct image image;         /* Cached image. */
+  };
+
+static struct image_entry image_entries[IMAGE_CACHE_SIZE];
+static struct list image_lru;   /* All entries, most recently used first. */
+static struct lock image_lock;  /* Protects the image cache. */
+static unsigned image_gen;      /* Incremented on every invalidation. */
+
+static bool get_image (struct file *, struct image *);
+static bool setup_stack (void **esp, const char *cmdline);
 static bool validate_segment (const struct Elf32_Phdr *, struct file *);
 static bool load_segment (struct file *file, off_t ofs, uint8_t *upage,
                           uint32_t read_bytes, uint32_t zero_bytes,
                           bool writable);
 
-/* Loads an ELF executable from FILE_NAME into the current thread.
-   Stores the executable's entry point into *EIP
-   and its initial stack pointer into *ESP.
+/* Loads the ELF executable named by the first word of CMDLINE
+   into the current thread and sets up its stack with the words
+   of CMDLINE as arguments.  Stores the executable's entry point
+   into *EIP and its initial stack pointer into *ESP.
    Returns true if successful, false otherwise. */
 
 bool load (const char *cmdline, void (**eip) (void), void **esp) 
 {
   struct thread *t = thread_current ();
-  struct Elf32_Ehdr ehdr;
+  struct image image;
   struct file *file = NULL;
-  off_t file_ofs;
   bool success = false; //Stores true if the executable successfully loads
-  int i; //Counter
-  char *args[30];
-  int count = 0; //Stores argument count
-  char *save_ptr;
-  char *cmd_copy = cmdline;
-  char *file_name;
-
-  //Tokenization of arguments and adding to array
-  char *token; //Used to store tokens for each arg
-  for (token = strtok_r(cmd_copy, " ", &save_ptr); token != NULL; token = strtok_r(NULL, " ", &save_ptr))
-  {
-	  args[count] = token;
-	  count++;
-	  printf("%s\n", args[count]);
-  }
+  size_t i; //Counter
+  char file_name[NAME_MAX + 1];
+  size_t name_len;
 
   //Setting file name
-  file_name = args[0];
+  name_len = program_name (file_name, sizeof file_name, cmdline);
 
   /* Allocate and activate page directory. */
   t->pagedir = pagedir_create ();
@@ -300,7 +521,7 @@ bool load (const char *cmdline, void (**eip) (void), void **esp)
   process_activate ();
 
   /* Open executable file. */
-  file = filesys_open (file_name);
+  file = name_len < sizeof file_name ? filesys_open (file_name) : NULL;
 
   //Check file is not a NULL value
   if (file == NULL) 
@@ -309,7 +530,92 @@ bool load (const char *cmdline, void (**eip) (void), void **esp)
       goto done; 
     }
 
+  /* Find the executable's loadable segments. */
+  if (!get_image (file, &image))
+    {
+      printf ("load: %s: error loading executable\n", file_name);
+      goto done; 
+    }
+
+  /* Load them. */
+  for (i = 0; i < image.seg_cnt; i++)
+    {
+      const struct image_segment *seg = &image.segs[i];
+      if (!load_segment (file, seg->file_page, (void *) seg->mem_page,
+                         seg->read_bytes, seg->zero_bytes, seg->writable))
+        goto done;
+    }
+
+  /* Set up stack. */
+  if (!setup_stack (esp, cmdline))
+    goto done;
+
+  /* Start address. */
+  *eip = (void (*) (void)) image.entry;
+
+  success = true;
+
+ done:
+  /* We arrive here whether the load is successful or not. */
+  file_close (file);
+  //When success is returned the arguments are pushed to the stack in the
+  //start_process function.
+  return success;
+}
+
+/* load() helpers. */
+
+/* Initializes the executable image cache. */
+void
+process_init (void)
+{
+  size_t i;
+
+  list_init (&image_lru);
+  lock_init (&image_lock);
+  for (i = 0; i < IMAGE_CACHE_SIZE; i++)
+    list_push_back (&image_lru, &image_entries[i].elem);
+}
+
+/* Drops any cached image of the executable whose inode is in
+   SECTOR.  Called by the file system after the inode is written
+   to and before its sectors are freed. */
+void
+process_invalidate_image (block_sector_t sector)
+{
+  struct list_elem *e;
+
+  lock_acquire (&image_lock);
+  image_gen++;
+  for (e = list_begin (&image_lru); e != list_end (&image_lru);
+       e = list_next (e))
+    {
+      struct image_entry *ie = list_entry (e, struct image_entry, elem);
+      if (ie->in_use && ie->sector == sector)
+        {
+          /* Free entries go to the back, to be reused first. */
+          ie->in_use = false;
+          list_remove (e);
+          list_push_back (&image_lru, e);
+          break;
+        }
+    }
+  lock_release (&image_lock);
+}
+
+/* Reads and validates the ELF headers of executable FILE and
+   stores its entry point and loadable segments into IMAGE.
+   Returns true if successful, false if FILE is not a loadable
+   executable. */
+static bool
+parse_image (struct file *file, struct image *image)
+{
+  struct Elf32_Ehdr ehdr;
+  off_t file_ofs;
+  int i;
+
   /* Read and verify executable header. */
+  file_seek (file, 0);
   if (file_read (file, &ehdr, sizeof ehdr) != sizeof ehdr
       || memcmp (ehdr.e_ident, "\177ELF\1\1\1", 7)
       || ehdr.e_type != 2
@@ -317,23 +623,22 @@ bool load (const char *cmdline, void (**eip) (void), void **esp)
       || ehdr.e_version != 1
       || ehdr.e_phentsize != sizeof (struct Elf32_Phdr)
       || ehdr.e_phnum > 1024) 
-    {
-      printf ("load: %s: error loading executable\n", file_name);
-      goto done; 
-    }
+    return false;
 
   /* Read program headers. */
+  image->entry = ehdr.e_entry;
+  image->seg_cnt = 0;
   file_ofs = ehdr.e_phoff;
   for (i = 0; i < ehdr.e_phnum; i++) 
     {
       struct Elf32_Phdr phdr;
 
       if (file_ofs < 0 || file_ofs > file_length (file))
-        goto done;
+        return false;
       file_seek (file, file_ofs);
 
       if (file_read (file, &phdr, sizeof phdr) != sizeof phdr)
-        goto done;
+        return false;
       file_ofs += sizeof phdr;
       switch (phdr.p_type) 
         {
@@ -347,60 +652,92 @@ bool load (const char *cmdline, void (**eip) (void), void **esp)
         case PT_DYNAMIC:
         case PT_INTERP:
         case PT_SHLIB:
-          goto done;
+          return false;
         case PT_LOAD:
-          if (validate_segment (&phdr, file)) 
+          if (validate_segment (&phdr, file)
+              && image->seg_cnt < IMAGE_SEGS_MAX) 
             {
-              bool writable = (phdr.p_flags & PF_W) != 0;
-              uint32_t file_page = phdr.p_offset & ~PGMASK;
-              uint32_t mem_page = phdr.p_vaddr & ~PGMASK;
+              struct image_segment *seg = &image->segs[image->seg_cnt++];
               uint32_t page_offset = phdr.p_vaddr & PGMASK;
-              uint32_t read_bytes, zero_bytes;
+
+              seg->writable = (phdr.p_flags & PF_W) != 0;
+              seg->file_page = phdr.p_offset & ~PGMASK;
+              seg->mem_page = phdr.p_vaddr & ~PGMASK;
               if (phdr.p_filesz > 0)
                 {
                   /* Normal segment.
                      Read initial part from disk and zero the rest. */
-                  read_bytes = page_offset + phdr.p_filesz;
-                  zero_bytes = (ROUND_UP (page_offset + phdr.p_memsz, PGSIZE)
-                                - read_bytes);
+                  seg->read_bytes = page_offset + phdr.p_filesz;
+                  seg->zero_bytes = (ROUND_UP (page_offset + phdr.p_memsz,
+                                               PGSIZE)
+                                     - seg->read_bytes);
                 }
               else 
                 {
                   /* Entirely zero.
                      Don't read anything from disk. */
-                  read_bytes = 0;
-                  zero_bytes = ROUND_UP (page_offset + phdr.p_memsz, PGSIZE);
+                  seg->read_bytes = 0;
+                  seg->zero_bytes = ROUND_UP (page_offset + phdr.p_memsz,
+                                              PGSIZE);
                 }
-              if (!load_segment (file, file_page, (void *) mem_page,
-                                 read_bytes, zero_bytes, writable))
-                goto done;
             }
           else
-            goto done;
+            return false;
           break;
         }
     }
+  return true;
+}
 
-  /* Set up stack. */
-  if (!setup_stack (esp, count, args))
-    goto done;
-
-  /* Start address. */
-  *eip = (void (*) (void)) ehdr.e_entry;
+/* Stores the entry point and loadable segments of executable
+   FILE into IMAGE, from the image cache if possible and
+   otherwise by parsing FILE's headers and caching the result.
+   Returns true if successful, false if FILE is not a loadable
+   executable. */
+static bool
+get_image (struct file *file, struct image *image)
+{
+  block_sector_t sector = inode_get_inumber (file_get_inode (file));
+  struct image_entry *ie;
+  struct list_elem *e;
+  unsigned gen;
+
+  lock_acquire (&image_lock);
+  for (e = list_begin (&image_lru); e != list_end (&image_lru);
+       e = list_next (e))
+    {
+      ie = list_entry (e, struct image_entry, elem);
+      if (ie->in_use && ie->sector == sector)
+        {
+          *image = ie->image;
+          list_remove (e);
+          list_push_front (&image_lru, e);
+          image_hit_cnt++;
+          lock_release (&image_lock);
+          return true;
+        }
+    }
+  image_miss_cnt++;
+  gen = image_gen;
+  lock_release (&image_lock);
 
-  success = true;
+  if (!parse_image (file, image))
+    return false;
 
- done:
-  /* We arrive here whether the load is successful or not. */
-  file_close (file);
-  //When success is returned the arguments are pushed to the stack in the
-  //start_process function.
-  return success;
+  /* Cache the image in the least recently used entry, unless a
+     write may have raced with our parsing. */
+  lock_acquire (&image_lock);
+  if (gen == image_gen)
+    {
+      ie = list_entry (list_pop_back (&image_lru), struct image_entry, elem);
+      ie->in_use = true;
+      ie->sector = sector;
+      ie->image = *image;
+      list_push_front (&image_lru, &ie->elem);
+    }
+  lock_release (&image_lock);
+  return true;
 }
-
-/* load() helpers. */
-
-static bool install_page (void *upage, void *kpage, bool writable);
 
 /* Checks whether PHDR describes a valid, loadable segment in
    FILE and returns true if so, false otherwise. */
@@ -506,74 +843,87 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
   return true;
 }
 
-/* Create a minimal stack by mapping a zeroed page at the top of
-   user virtual memory. */
-//Setup stack receives the current esp the argument count and an array of args
-static bool setup_stack (void **esp, int argc, char *args[]) 
+/* Returns the number of space-separated words in CMDLINE. */
+static int
+count_args (const char *cmdline)
 {
-  uint8_t *kpage;
-  bool success = false;
-  //int sSize = 0; //Variable to store the current size of the stack (debug)
-
-  kpage = palloc_get_page (PAL_USER | PAL_ZERO);
-  if (kpage != NULL) 
-    
-      success = install_page (((uint8_t *) PHYS_BASE) - PGSIZE, kpage, true);
-      if (success) 
-	{
-        *esp = PHYS_BASE;
-	//Stack management
-	uint32_t argv[argc]; //Stores the address pointers to args
-
-	//Looping through args and setting stack pointer to to each arg
-	for (int i = argc; i > 0; i--)
-	{
-	*esp -= (strlen(args[i - 1]) + 1) * sizeof(char); //decrease the stack pointer by arglen
-	strlcpy(*esp, args[i - 1], strlen(args[i - 1]) + 1); //storing arg in current esp
-	argv[i - 1] = (uint32_t*) *esp; //Storing arg location in argv array
-	//sSize += (strlen(args[i - 1]) + 1) * sizeof(char);
-	}
-
-	//Word align/rounding to nearest 4 byte chunk of memory
-	int align = (size_t) *esp % 4;
-	*esp -= align; //Take align amount of stack pointer to reach start of chunk
-	memset(*esp, 0, align); //Fill memory at stack pointer
-	//sSize =+ align; //Accumulate stack size variable
-
-	//Adding last chunk of 0 to indicate end of args
-	*esp -= sizeof(int*); //Making space for 0s
-	(*(int*)(*esp)) = 0; //Setting the chunk to 0s
-	//sSize += sizeof(int*);
-
-	//Making space for and storing locations on stack
-	for (int n = argc; n > 0; n--)
-	{
-		*esp = *esp - sizeof(uint32_t**); //Creates space for arg location
-		memcpy(*esp, &argv[n - 1], sizeof(uint32_t*)); //copying location
-		//sSize += sizeof(uint32_t**);
-	}
-
-	//Adding starting points of the arguments
-	void **argStart = *esp; //This stores the start point of args
-	*esp -= sizeof(void**); //Decrement pointer to make space for start point
-	memcpy(*esp, &argStart, sizeof(void**)); //Copy start point into pointer loc
-	//sSize += sizeof(void**);
-
-	//Adding argument count to the stack
-	*esp -= sizeof(int); //Decrementing pointer to create space for argc
-	memcpy(*esp, &argc, sizeof(int)); //Copying argc into pointer location
-	//sSize =+ sizeof(int);
-
-	//Adding return address to the stack
-	*esp -= sizeof(void*); //Decrementing pointer to create space for ret addr
-	memset(*esp, 0, sizeof(void*)); //Storing return addr in pointer location
-	//sSize += sizeof(void*);
-	} 
-	else 
-	{
-        palloc_free_page (kpage);
-	}
-  return success;
+  int argc = 0;
+
+  for (;;)
+    {
+      cmdline += strspn (cmdline, " ");
+      if (*cmdline == '\0')
+        return argc;
+      argc++;
+      cmdline += strcspn (cmdline, " ");
+    }
+}
+
+/* Creates the initial user stack at the top of user virtual
+   memory and lays out the program arguments on it as the 80x86
+   calling convention expects: the words of CMDLINE, word
+   aligned, then the argv[] array with a null sentinel, argv,
+   argc and a fake return address.
+
+   CMDLINE, which may be up to a page long, is copied into the
+   stack exactly once and tokenized in place, and argv[] is
+   filled in the same pass, so no other memory is needed.  The
+   stack gets as many zeroed pages as the arguments require.  The
+   new page directory must already be active. */
+static bool
+setup_stack (void **esp, const char *cmdline) 
+{
+  struct thread *t = thread_current ();
+  size_t len = strlen (cmdline);
+  int argc = count_args (cmdline);
+  size_t size, page_cnt, i;
+  char *strings, *token, *save_ptr;
+  char **argv;
+  uint32_t *sp;
+
+  size = (ROUND_UP (len + 1, sizeof (uint32_t))
+          + (argc + 1) * sizeof *argv         /* argv[] and sentinel. */
+          + sizeof argv + sizeof argc         /* argv, argc. */
+          + sizeof (void *));                 /* Return address. */
+  page_cnt = DIV_ROUND_UP (size, PGSIZE);
+  if (page_cnt > process_stack_limit)
+    return false;
+
+  /* Map the stack pages.  Pages installed before a failure are
+     freed along with the page directory. */
+  for (i = 0; i < page_cnt; i++)
+    {
+      uint8_t *upage = (uint8_t *) PHYS_BASE - (i + 1) * PGSIZE;
+      uint8_t *kpage = palloc_get_page (PAL_USER | PAL_ZERO);
+
+      if (kpage == NULL)
+        return false;
+      if (!install_page (upage, kpage, true))
+        {
+          palloc_free_page (kpage);
+          return false;
+        }
+    }
+  t->stack_pages = page_cnt;
+
+  /* Copy the command line to the top of the stack and split it
+     into words in place, filling in argv[] as we go. */
+  strings = (char *) PHYS_BASE - (len + 1);
+  memcpy (strings, cmdline, len + 1);
+  argv = (char **) ROUND_DOWN ((uintptr_t) strings, sizeof (uint32_t))
+         - (argc + 1);
+  i = 0;
+  for (token = strtok_r (strings, " ", &save_ptr); token != NULL;
+       token = strtok_r (NULL, " ", &save_ptr))
+    argv[i++] = token;
+  argv[argc] = NULL;
+
+  sp = (uint32_t *) argv;
+  *--sp = (uint32_t) argv;
+  *--sp = argc;
+  *--sp = 0;
+  *esp = sp;
+  return true;
 }
 
 /* Adds a mapping from user virtual address UPAGE to kernel
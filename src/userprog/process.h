@@ -2,13 +2,25 @@
 #define USERPROG_PROCESS_H
 
 #include "threads/thread.h"
+#include "devices/block.h"
 
 //Variable type used to store process ID
 typedef int pid_t;
 
+/* Default maximum size of a user stack, in pages (8 MB).
+   Overridden by kernel command-line option "-stack=PAGES". */
+#define STACK_MAX_PAGES 2048
+
+/* Maximum size of each process's user stack, in pages. */
+extern size_t process_stack_limit;
+
+void process_init (void);
 tid_t process_execute (const char *file_name);
 int process_wait (tid_t);
 void process_exit (void);
 void process_activate (void);
+bool process_grow_stack (void *fault_addr, const void *esp);
+void process_print_stats (void);
+void process_invalidate_image (block_sector_t);
 
 #endif /* userprog/process.h */
@@ -0,0 +1,166 @@
+#include "userprog/shm.h"
+#include <debug.h>
+#include <list.h>
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/pagedir.h"
+
+/* A shared page. */
+struct shm_page
+  {
+    struct list_elem elem;      /* Element in shm_pages. */
+    int key;                    /* Key that names the page. */
+    void *kpage;                /* Kernel address of the frame. */
+    int ref_cnt;                /* Number of attachments. */
+  };
+
+/* A shared page attached to a process. */
+struct shm_map
+  {
+    struct list_elem elem;      /* Element in thread's shm_maps. */
+    void *upage;                /* User address of the mapping. */
+    struct shm_page *page;      /* The page mapped there. */
+  };
+
+/* All shared pages with at least one attachment. */
+static struct list shm_pages;
+
+/* Protects shm_pages and every page's ref_cnt. */
+static struct lock shm_lock;
+
+static struct shm_page *lookup_page (int key);
+static void release_page (struct shm_page *);
+
+/* Initializes the shared memory module. */
+void
+shm_init (void)
+{
+  list_init (&shm_pages);
+  lock_init (&shm_lock);
+}
+
+/* Maps the shared page named KEY at UPAGE in the running
+   process, creating it, zeroed, if no process has it attached.
+   UPAGE must be page-aligned and not yet mapped.  Returns true
+   if successful, false if memory is short. */
+bool
+shm_attach (int key, void *upage)
+{
+  struct thread *t = thread_current ();
+  struct shm_map *map;
+  struct shm_page *page;
+
+  ASSERT (pg_ofs (upage) == 0);
+  ASSERT (pagedir_get_page (t->pagedir, upage) == NULL);
+
+  map = malloc (sizeof *map);
+  if (map == NULL)
+    return false;
+
+  lock_acquire (&shm_lock);
+  page = lookup_page (key);
+  if (page == NULL)
+    {
+      page = malloc (sizeof *page);
+      if (page == NULL)
+        goto fail;
+      page->kpage = palloc_get_page (PAL_USER | PAL_ZERO);
+      if (page->kpage == NULL)
+        {
+          free (page);
+          goto fail;
+        }
+      page->key = key;
+      page->ref_cnt = 0;
+      list_push_back (&shm_pages, &page->elem);
+    }
+  page->ref_cnt++;
+
+  if (!pagedir_set_page (t->pagedir, upage, page->kpage, true))
+    {
+      release_page (page);
+      goto fail;
+    }
+  lock_release (&shm_lock);
+
+  map->upage = upage;
+  map->page = page;
+  list_push_back (&t->shm_maps, &map->elem);
+  return true;
+
+ fail:
+  lock_release (&shm_lock);
+  free (map);
+  return false;
+}
+
+/* Unmaps every shared page attached to the running process,
+   freeing pages that no other process has attached.  Called as
+   the process exits, before its page directory is destroyed, so
+   that pagedir_destroy() does not free frames that other
+   processes still map. */
+void
+shm_detach_all (void)
+{
+  struct thread *t = thread_current ();
+
+  while (!list_empty (&t->shm_maps))
+    {
+      struct shm_map *map = list_entry (list_pop_front (&t->shm_maps),
+                                        struct shm_map, elem);
+      pagedir_clear_page (t->pagedir, map->upage);
+      lock_acquire (&shm_lock);
+      release_page (map->page);
+      lock_release (&shm_lock);
+      free (map);
+    }
+}
+
+/* Returns true if KPAGE is the frame of a shared page attached
+   to the running process. */
+bool
+shm_is_shared (const void *kpage)
+{
+  struct list *maps = &thread_current ()->shm_maps;
+  struct list_elem *e;
+
+  /* Only the running process changes its own list, and its
+     attachments keep their pages alive, so no lock is needed. */
+  for (e = list_begin (maps); e != list_end (maps); e = list_next (e))
+    if (list_entry (e, struct shm_map, elem)->page->kpage == kpage)
+      return true;
+  return false;
+}
+
+/* Returns the shared page named KEY, or a null pointer if there
+   is none.  The caller must hold shm_lock. */
+static struct shm_page *
+lookup_page (int key)
+{
+  struct list_elem *e;
+
+  for (e = list_begin (&shm_pages); e != list_end (&shm_pages);
+       e = list_next (e))
+    {
+      struct shm_page *page = list_entry (e, struct shm_page, elem);
+      if (page->key == key)
+        return page;
+    }
+  return NULL;
+}
+
+/* Drops an attachment of PAGE, freeing it if that was the last.
+   The caller must hold shm_lock. */
+static void
+release_page (struct shm_page *page)
+{
+  if (--page->ref_cnt == 0)
+    {
+      list_remove (&page->elem);
+      palloc_free_page (page->kpage);
+      free (page);
+    }
+}
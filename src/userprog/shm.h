@@ -0,0 +1,21 @@
+#ifndef USERPROG_SHM_H
+#define USERPROG_SHM_H
+
+#include <stdbool.h>
+
+/* Shared memory pages.
+
+   A process attaches the shared page named by an int key at a
+   page of its address space with shm_attach().  Every process
+   that attaches the same key maps the same frame, so they see
+   each other's stores, and futexes in the page can be slept on
+   and woken from different processes.  A page is created on the
+   first attachment of its key and freed when the last process
+   attached to it exits. */
+
+void shm_init (void);
+bool shm_attach (int key, void *upage);
+void shm_detach_all (void);
+bool shm_is_shared (const void *kpage);
+
+#endif /* userprog/shm.h */
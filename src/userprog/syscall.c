@@ -1,28 +1,41 @@
 #include "userprog/syscall.h"
+#include <limits.h>
+#include <ring.h>
 #include <stdio.h>
 #include <syscall-nr.h>
+#include <trace.h>
+#include <uio.h>
 #include "threads/interrupt.h"
 #include "threads/thread.h"
+#include "userprog/fdtable.h"
+#include "userprog/futex.h"
+#include "userprog/pagedir.h"
+#include "userprog/pipe.h"
 #include "userprog/process.h"
+#include "userprog/shm.h"
+#include "userprog/usermem.h"
+#include "filesys/directory.h"
 #include "filesys/filesys.h"
 #include "filesys/file.h"
 #include "devices/shutdown.h"
 #include "devices/input.h"
 #include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
 #include "threads/vaddr.h"
 
-//definitions for argument codes
-//stores the value that will be added to the stack pointer depending on which
-//system call is used
-#define ARG_CODE 0
-#define ARG_0 4
-#define ARG_1 8
-#define ARG_2 12
+/* Console file descriptors. */
+#define STDIN_FILENO 0
+#define STDOUT_FILENO 1
 
-//declaration of the loadStack function
-static uint32_t loadStack (struct intr_frame *itrf, int);
+/* Largest chunk written to the console in one putbuf() call, so
+   that output from different processes interleaves in
+   reasonably sized pieces. */
+#define CONSOLE_CHUNK 256
 
-static struct semaphore *fileLock;
+static void copy_in (void *dst, const void *usrc, size_t size);
+static bool copy_in_string (char *dst, const char *ustr, size_t size);
+static void check_buffer (const void *ubuf, size_t size, bool write);
 
 //declaration of the syscall handler
 static void syscall_handler (struct intr_frame *itrf);
@@ -45,75 +58,201 @@ bool sys_remove (const char *f);
 bool sys_create (const char *n, unsigned int size);
 //  sys_create declaration
 
+static int sys_open (const char *filename);
+static int sys_filesize (int fd);
+static int sys_read (int fd, void *buffer, unsigned size);
+static int sys_write (int fd, const void *buffer, unsigned size);
+static void sys_seek (int fd, unsigned position);
+static unsigned sys_tell (int fd);
+static void sys_close (int fd);
+static int sys_readv (int fd, const struct iovec *iov, int iovcnt);
+static int sys_writev (int fd, const struct iovec *iov, int iovcnt);
+static int sys_pread (int fd, void *buffer, unsigned size, unsigned offset);
+static int sys_pwrite (int fd, const void *buffer, unsigned size,
+                       unsigned offset);
+static bool sys_ring_setup (struct sq_ring *uring);
+static int sys_ring_enter (unsigned to_submit);
+static int sys_futex_wait (int *uaddr, int val);
+static int sys_futex_wake (int *uaddr, int cnt);
+static int sys_pipe (int *ufds);
+static bool sys_shm_attach (int key, void *upage);
+
+/* A system call handler, as called from syscall_handler().  ARG
+   holds the raw argument words from the user stack, of which the
+   handler uses as many as the system call takes.  The result is
+   returned to the user in eax. */
+typedef int syscall_function (const uint32_t arg[]);
+
+/* Defines NAME##_stub, a syscall_function that calls NAME with
+   ARGS, an argument list built from ARG[0], ARG[1], ..., each
+   converted to the type of the corresponding parameter, and
+   returns NAME's result. */
+#define STUB(NAME, ARGS)                                        \
+        static int                                              \
+        NAME##_stub (const uint32_t arg[] UNUSED)               \
+        {                                                       \
+          return NAME ARGS;                                     \
+        }
+
+/* Like STUB, for a NAME that returns void.  The user sees 0. */
+#define VOID_STUB(NAME, ARGS)                                   \
+        static int                                              \
+        NAME##_stub (const uint32_t arg[] UNUSED)               \
+        {                                                       \
+          NAME ARGS;                                            \
+          return 0;                                             \
+        }
+
+VOID_STUB (sys_halt, ())
+VOID_STUB (sys_exit, ((int) arg[0]))
+STUB (sys_exec, ((const char *) arg[0]))
+STUB (sys_wait, ((pid_t) arg[0]))
+STUB (sys_create, ((const char *) arg[0], (unsigned) arg[1]))
+STUB (sys_remove, ((const char *) arg[0]))
+STUB (sys_open, ((const char *) arg[0]))
+STUB (sys_filesize, ((int) arg[0]))
+STUB (sys_read, ((int) arg[0], (void *) arg[1], (unsigned) arg[2]))
+STUB (sys_write, ((int) arg[0], (const void *) arg[1], (unsigned) arg[2]))
+VOID_STUB (sys_seek, ((int) arg[0], (unsigned) arg[1]))
+STUB (sys_tell, ((int) arg[0]))
+VOID_STUB (sys_close, ((int) arg[0]))
+STUB (sys_readv, ((int) arg[0], (const struct iovec *) arg[1], (int) arg[2]))
+STUB (sys_writev, ((int) arg[0], (const struct iovec *) arg[1], (int) arg[2]))
+STUB (sys_pread, ((int) arg[0], (void *) arg[1], (unsigned) arg[2],
+                  (unsigned) arg[3]))
+STUB (sys_pwrite, ((int) arg[0], (const void *) arg[1], (unsigned) arg[2],
+                   (unsigned) arg[3]))
+STUB (sys_ring_setup, ((struct sq_ring *) arg[0]))
+STUB (sys_ring_enter, ((unsigned) arg[0]))
+STUB (sys_futex_wait, ((int *) arg[0], (int) arg[1]))
+STUB (sys_futex_wake, ((int *) arg[0], (int) arg[1]))
+STUB (sys_pipe, ((int *) arg[0]))
+STUB (sys_shm_attach, ((int) arg[0], (void *) arg[1]))
+
+/* A system call. */
+struct syscall
+  {
+    size_t arg_cnt;             /* Number of arguments. */
+    syscall_function *func;     /* Implementation. */
+  };
+
+/* Initializer for a syscall_table entry for FUNC, which takes
+   ARG_CNT arguments and has a stub defined above. */
+#define SYSCALL(ARG_CNT, FUNC) {ARG_CNT, FUNC##_stub}
+
+/* Table of system calls, indexed by system call number. */
+static const struct syscall syscall_table[] =
+  {
+    [SYS_HALT] = SYSCALL (0, sys_halt),
+    [SYS_EXIT] = SYSCALL (1, sys_exit),
+    [SYS_EXEC] = SYSCALL (1, sys_exec),
+    [SYS_WAIT] = SYSCALL (1, sys_wait),
+    [SYS_CREATE] = SYSCALL (2, sys_create),
+    [SYS_REMOVE] = SYSCALL (1, sys_remove),
+    [SYS_OPEN] = SYSCALL (1, sys_open),
+    [SYS_FILESIZE] = SYSCALL (1, sys_filesize),
+    [SYS_READ] = SYSCALL (3, sys_read),
+    [SYS_WRITE] = SYSCALL (3, sys_write),
+    [SYS_SEEK] = SYSCALL (2, sys_seek),
+    [SYS_TELL] = SYSCALL (1, sys_tell),
+    [SYS_CLOSE] = SYSCALL (1, sys_close),
+    [SYS_READV] = SYSCALL (3, sys_readv),
+    [SYS_WRITEV] = SYSCALL (3, sys_writev),
+    [SYS_PREAD] = SYSCALL (4, sys_pread),
+    [SYS_PWRITE] = SYSCALL (4, sys_pwrite),
+    [SYS_RING_SETUP] = SYSCALL (1, sys_ring_setup),
+    [SYS_RING_ENTER] = SYSCALL (1, sys_ring_enter),
+    [SYS_FUTEX_WAIT] = SYSCALL (2, sys_futex_wait),
+    [SYS_FUTEX_WAKE] = SYSCALL (2, sys_futex_wake),
+    [SYS_PIPE] = SYSCALL (1, sys_pipe),
+    [SYS_SHM_ATTACH] = SYSCALL (2, sys_shm_attach),
+  };
+
+#define SYSCALL_CNT (sizeof syscall_table / sizeof *syscall_table)
 
 void
-syscall_init (void) 
+syscall_init (void)
 {
   intr_register_int (0x30, 3, INTR_ON, syscall_handler, "syscall");
-  sema_init (&fileLock, 1);
-  //initialises the semaphore. 
+  futex_init ();
+  shm_init ();
 }
 
-// Controls the system calls cases 
+/* Looks up the system call number on the user stack in
+   syscall_table, fetches its arguments and stores its return
+   value in the caller's eax. */
 static void
 syscall_handler (struct intr_frame *itrf)
 {
+  const struct syscall *sc;
+  unsigned syscode;
+  uint32_t args[4];
+
+  /* Remember the user stack pointer so that page faults taken
+     while the kernel touches user memory can grow the stack. */
+  thread_current ()->user_esp = itrf->esp;
+
+  /* The system call number is at the top of the user stack, with
+     its arguments just above it. */
+  copy_in (&syscode, itrf->esp, sizeof syscode);
+  if (syscode >= SYSCALL_CNT || syscall_table[syscode].func == NULL)
+    sys_exit (-1);
+  sc = &syscall_table[syscode];
+  copy_in (args, (uint32_t *) itrf->esp + 1, sizeof *args * sc->arg_cnt);
+
+  TRACE (TRACE_SYSCALL_ENTER, syscode, 0, 0);
+  itrf->eax = sc->func (args);
+  TRACE (TRACE_SYSCALL_EXIT, syscode, itrf->eax, 0);
+}
 
-  int syscode = (int) loadStack (itrf, ARG_CODE); //Holds syscall code
-
-  switch (syscode)
-  {
-	//creation of SYS_EXIT sytem call case state  
-	case SYS_EXIT:
-		sys_exit ((int) loadStack (itrf, ARG_0));
-		printf("System Exit Call!");
-		break;
-
-
-	//creation of SYS_WAIT system call case state | itrf points to eax
-	//register which stores return of function	
-	case SYS_WAIT:
-		itrf->eax = sys_wait ((pid_t) loadStack (itrf, ARG_0));
-		printf("System Wait Call!");
-		break;
-
-
-	//creation of SYS_HALT system call case state	
-	case SYS_HALT:
-		sys_halt();
-		printf("System Halt Call!");
-		break;
-
-
-	//creation of SYS_EXEC system call case state
-	case SYS_EXEC:
-		itrf->eax = sys_exec ((const char *) loadStack (itrf, ARG_0));
-		printf("System Execute Call!");
-		break;
-
-
-	//creation of SYS_REMOVE system call case state
-	case SYS_REMOVE:
-		itrf->eax = sys_remove ((const char *) loadStack (itrf, ARG_0));
-		break;
-	
+/* Copies SIZE bytes from user address USRC to DST.
+   Terminates the process if any of the bytes is invalid. */
+static void
+copy_in (void *dst, const void *usrc, size_t size)
+{
+  if (!copy_from_user (dst, usrc, size))
+    sys_exit (-1);
+}
 
-	//creation of SYS_CREATE system call case state
-	case SYS_CREATE:
-		itrf->eax = sys_create ((const char *) loadStack (itrf	, ARG_0),
-		(unsigned int) loadStack (itrf, ARG_1));
-		break;
-	}
+/* Copies the null-terminated string at user address USTR into
+   the SIZE-byte buffer DST.  Returns true if successful, false
+   if the string is too long to fit.  Terminates the process if
+   the string is not valid user memory. */
+static bool
+copy_in_string (char *dst, const char *ustr, size_t size)
+{
+  int len = strncpy_from_user (dst, ustr, size);
+  if (len < 0)
+    sys_exit (-1);
+  return (size_t) len < size;
+}
 
-  thread_exit ();
+/* Terminates the process unless the SIZE bytes at user address
+   UBUF may be read, or written as well if WRITE is true. */
+static void
+check_buffer (const void *ubuf, size_t size, bool write)
+{
+  if (!probe_user (ubuf, size, write))
+    sys_exit (-1);
+}
 
+/* Returns the file open as FD in the current process, or a null
+   pointer if FD is not an open file. */
+static struct file *
+lookup_file (int fd)
+{
+  struct fdtable *fds = thread_current ()->fds;
+  return fds != NULL ? fdtable_lookup (fds, fd) : NULL;
 }
 
-static uint32_t loadStack(struct intr_frame *itrf, int store)
+/* Returns the pipe whose write end (if WRITER is true) or read
+   end (otherwise) is open as FD in the current process, or a
+   null pointer if FD is not such a pipe end. */
+static struct pipe *
+lookup_pipe (int fd, bool writer)
 {
-	//returns a 32-bit stack pointer plus the ARG_CODE value (0,4,8,12)
-	//pointer to by the interrupt frame	
-	return *((uint32_t *) (itrf->esp + store));
+  struct fdtable *fds = thread_current ()->fds;
+  return fds != NULL ? fdtable_lookup_pipe (fds, fd, writer) : NULL;
 }
 
 // The function for sys_exit which terminates the current process being executed
@@ -141,19 +280,24 @@ void sys_halt (void)
 // command line
 pid_t sys_exec (const char *cmd_line)
 {
-	return process_execute (cmd_line);
+	char *kcmd = palloc_get_page (0); //kernel copy of the command line
+	pid_t pid = TID_ERROR;
+
+	if (kcmd == NULL)
+		return TID_ERROR;
+	if (copy_in_string (kcmd, cmd_line, PGSIZE))
+		pid = process_execute (kcmd);
+	palloc_free_page (kcmd);
+	return pid;
 }
 
 // The function for sys_remove removes a name from the file system
 bool
 sys_remove (const char *filename)
 {
-	bool complete; //Stores true if completed
-	sema_down (&fileLock); 
-	//when sema down is called it locks the file so other system call cannot access it
-	complete = filesys_remove (filename); //removes the given file
-	sema_up (&fileLock); //sema_up on fileLock indicates the file is avaliable again
-	return complete;
+	char name[NAME_MAX + 1]; //kernel copy of the file name
+	return copy_in_string (name, filename, sizeof name)
+	       && filesys_remove (name); //removes the given file
 }
 
 // the function for sys_create creates new files and returns whether they are
@@ -162,9 +306,429 @@ sys_remove (const char *filename)
 bool
 sys_create (const char *filename, unsigned int size)
 {
-	bool complete; //Stores true if completed
-	sema_down (&fileLock); //Locks the file
-	complete = filesys_create (filename, size); //creates the file with a name and size
-	sema_up (&fileLock); //Unlocks the file
-	return complete;
+	char name[NAME_MAX + 1]; //kernel copy of the file name
+	return copy_in_string (name, filename, sizeof name)
+	       && filesys_create (name, size); //creates the file with a name and size
+}
+
+/* Opens FILENAME and returns a new file descriptor for it, or -1
+   if the file cannot be opened or the process has too many
+   files open. */
+static int
+sys_open (const char *filename)
+{
+  struct fdtable *fds = thread_current ()->fds;
+  char name[NAME_MAX + 1];
+  struct file *file;
+  int fd;
+
+  if (!copy_in_string (name, filename, sizeof name) || fds == NULL)
+    return -1;
+
+  file = filesys_open (name);
+  if (file == NULL)
+    return -1;
+
+  fd = fdtable_insert (fds, file);
+  if (fd == -1)
+    file_close (file);
+  return fd;
+}
+
+/* Returns the size of the file open as FD, or -1 if FD is not
+   open. */
+static int
+sys_filesize (int fd)
+{
+  struct file *file = lookup_file (fd);
+  return file != NULL ? file_length (file) : -1;
+}
+
+/* Reads up to SIZE bytes from FD into BUFFER, which has already
+   been checked.  Returns the number of bytes read, or -1 if FD
+   is not open for reading. */
+static int
+read_fd (int fd, void *buffer, unsigned size)
+{
+  struct file *file;
+  struct pipe *pipe;
+
+  if (fd == STDIN_FILENO)
+    {
+      uint8_t *dst = buffer;
+      unsigned i;
+
+      for (i = 0; i < size; i++)
+        dst[i] = input_getc ();
+      return size;
+    }
+
+  pipe = lookup_pipe (fd, false);
+  if (pipe != NULL)
+    return pipe_read (pipe, buffer, size);
+
+  file = lookup_file (fd);
+  return file != NULL ? file_read (file, buffer, size) : -1;
+}
+
+/* Writes SIZE bytes from BUFFER, which has already been checked,
+   to FD.  Returns the number of bytes written, or -1 if FD is
+   not open for writing. */
+static int
+write_fd (int fd, const void *buffer, unsigned size)
+{
+  struct file *file;
+  struct pipe *pipe;
+
+  if (fd == STDOUT_FILENO)
+    {
+      const char *src = buffer;
+      unsigned left = size;
+
+      while (left > 0)
+        {
+          size_t chunk = left < CONSOLE_CHUNK ? left : CONSOLE_CHUNK;
+          putbuf (src, chunk);
+          src += chunk;
+          left -= chunk;
+        }
+      return size;
+    }
+
+  pipe = lookup_pipe (fd, true);
+  if (pipe != NULL)
+    return pipe_write (pipe, buffer, size);
+
+  file = lookup_file (fd);
+  return file != NULL ? file_write (file, buffer, size) : -1;
+}
+
+/* Reads up to SIZE bytes from FD into BUFFER.  Returns the
+   number of bytes read, or -1 if FD is not open for reading. */
+static int
+sys_read (int fd, void *buffer, unsigned size)
+{
+  check_buffer (buffer, size, true);
+  return read_fd (fd, buffer, size);
+}
+
+/* Writes SIZE bytes from BUFFER to FD.  Returns the number of
+   bytes written, or -1 if FD is not open for writing. */
+static int
+sys_write (int fd, const void *buffer, unsigned size)
+{
+  check_buffer (buffer, size, false);
+  return write_fd (fd, buffer, size);
+}
+
+/* Copies the IOVCNT-element I/O vector at user address UIOV into
+   IOV and checks that each buffer it describes may be accessed,
+   for writing if WRITE is true.  Returns false if IOVCNT is out
+   of range or the buffers total more than INT_MAX bytes.
+   Terminates the process if any of the memory is invalid. */
+static bool
+copy_in_iovec (struct iovec iov[IOV_MAX], const struct iovec *uiov,
+               int iovcnt, bool write)
+{
+  size_t total = 0;
+  int i;
+
+  if (iovcnt < 0 || iovcnt > IOV_MAX)
+    return false;
+
+  copy_in (iov, uiov, sizeof *iov * iovcnt);
+  for (i = 0; i < iovcnt; i++)
+    {
+      if (iov[i].iov_len > INT_MAX - total)
+        return false;
+      total += iov[i].iov_len;
+      check_buffer (iov[i].iov_base, iov[i].iov_len, write);
+    }
+  return true;
+}
+
+/* Reads from FD into the IOVCNT buffers described by IOV, filling
+   each in turn.  Returns the total number of bytes read, which is
+   short only at end of file, or -1 on error. */
+static int
+sys_readv (int fd, const struct iovec *uiov, int iovcnt)
+{
+  struct iovec iov[IOV_MAX];
+  int total = 0;
+  int i;
+
+  if (!copy_in_iovec (iov, uiov, iovcnt, true))
+    return -1;
+
+  for (i = 0; i < iovcnt; i++)
+    {
+      int cnt = read_fd (fd, iov[i].iov_base, iov[i].iov_len);
+      if (cnt < 0)
+        return total > 0 ? total : -1;
+      total += cnt;
+      if ((size_t) cnt < iov[i].iov_len)
+        break;
+    }
+  return total;
+}
+
+/* Writes the IOVCNT buffers described by IOV to FD, in order.
+   Returns the total number of bytes written, which is short only
+   at end of file, or -1 on error. */
+static int
+sys_writev (int fd, const struct iovec *uiov, int iovcnt)
+{
+  struct iovec iov[IOV_MAX];
+  int total = 0;
+  int i;
+
+  if (!copy_in_iovec (iov, uiov, iovcnt, false))
+    return -1;
+
+  for (i = 0; i < iovcnt; i++)
+    {
+      int cnt = write_fd (fd, iov[i].iov_base, iov[i].iov_len);
+      if (cnt < 0)
+        return total > 0 ? total : -1;
+      total += cnt;
+      if ((size_t) cnt < iov[i].iov_len)
+        break;
+    }
+  return total;
+}
+
+/* Reads up to SIZE bytes from FD into BUFFER, starting at byte
+   OFFSET in the file, without moving the file position.
+   Returns the number of bytes read, or -1 if FD is not an open
+   file. */
+static int
+sys_pread (int fd, void *buffer, unsigned size, unsigned offset)
+{
+  struct file *file = lookup_file (fd);
+
+  check_buffer (buffer, size, true);
+  if (file == NULL || offset > INT_MAX)
+    return -1;
+  return file_read_at (file, buffer, size, offset);
+}
+
+/* Writes SIZE bytes from BUFFER to FD, starting at byte OFFSET in
+   the file, without moving the file position.  Returns the
+   number of bytes written, or -1 if FD is not an open file. */
+static int
+sys_pwrite (int fd, const void *buffer, unsigned size, unsigned offset)
+{
+  struct file *file = lookup_file (fd);
+
+  check_buffer (buffer, size, false);
+  if (file == NULL || offset > INT_MAX)
+    return -1;
+  return file_write_at (file, buffer, size, offset);
+}
+
+/* Returns true if the running process may map a page of its
+   own choosing at user address UPAGE: UPAGE must be non-null,
+   page-aligned, unmapped and outside the stack region. */
+static bool
+is_free_upage (const void *upage)
+{
+  uint8_t *stack_limit = (uint8_t *) PHYS_BASE - process_stack_limit * PGSIZE;
+
+  return (upage != NULL && pg_ofs (upage) == 0
+          && (const uint8_t *) upage < stack_limit
+          && pagedir_get_page (thread_current ()->pagedir, upage) == NULL);
+}
+
+/* Maps a zeroed system call ring at page-aligned user address
+   URING, which must be unmapped and outside the stack region.
+   Returns true if successful, false on failure or if the
+   process already has a ring. */
+static bool
+sys_ring_setup (struct sq_ring *uring)
+{
+  struct thread *t = thread_current ();
+  void *kpage;
+
+  if (t->ring != NULL || !is_free_upage (uring))
+    return false;
+
+  kpage = palloc_get_page (PAL_USER | PAL_ZERO);
+  if (kpage == NULL)
+    return false;
+  if (!pagedir_set_page (t->pagedir, uring, kpage, true))
+    {
+      palloc_free_page (kpage);
+      return false;
+    }
+
+  /* The page now belongs to the address space and is freed along
+     with it.  The kernel works on the ring through its own
+     mapping of the page. */
+  t->ring = kpage;
+  return true;
+}
+
+/* Carries out request SQE from the system call ring and returns
+   its result. */
+static int
+ring_dispatch (const struct sq_entry *sqe)
+{
+  void *addr = (void *) sqe->addr;
+
+  switch (sqe->opcode)
+    {
+    case RING_OP_NOP:
+      return 0;
+    case RING_OP_OPEN:
+      return sys_open (addr);
+    case RING_OP_CLOSE:
+      sys_close (sqe->fd);
+      return 0;
+    case RING_OP_READ:
+      return sys_read (sqe->fd, addr, sqe->len);
+    case RING_OP_WRITE:
+      return sys_write (sqe->fd, addr, sqe->len);
+    case RING_OP_PREAD:
+      return sys_pread (sqe->fd, addr, sqe->len, sqe->offset);
+    case RING_OP_PWRITE:
+      return sys_pwrite (sqe->fd, addr, sqe->len, sqe->offset);
+    default:
+      return -1;
+    }
+}
+
+/* Carries out up to TO_SUBMIT queued requests from the running
+   process's system call ring, in order, posting a completion for
+   each.  Stops early if the submission queue empties or the
+   completion queue fills.  Returns the number of requests
+   consumed, or -1 if the process has no ring. */
+static int
+sys_ring_enter (unsigned to_submit)
+{
+  struct sq_ring *ring = thread_current ()->ring;
+  unsigned done;
+
+  if (ring == NULL)
+    return -1;
+
+  for (done = 0; done < to_submit; done++)
+    {
+      struct sq_entry sqe;
+      struct cq_entry *cqe;
+      uint32_t head = ring->sq_head;
+
+      /* The indexes live in user-writable memory, so read each
+         just once and trust nothing beyond the slot it names. */
+      barrier ();
+      if (head == ring->sq_tail
+          || ring->cq_tail - ring->cq_head >= RING_ENTRIES)
+        break;
+
+      sqe = ring->sqes[head % RING_ENTRIES];
+      ring->sq_head = head + 1;
+
+      cqe = &ring->cqes[ring->cq_tail % RING_ENTRIES];
+      cqe->user_data = sqe.user_data;
+      cqe->res = ring_dispatch (&sqe);
+      barrier ();
+      ring->cq_tail++;
+    }
+  return done;
+}
+
+/* Maps the shared page named KEY at page-aligned user address
+   UPAGE, which must be unmapped and outside the stack region.
+   Returns true if successful, false otherwise. */
+static bool
+sys_shm_attach (int key, void *upage)
+{
+  return is_free_upage (upage) && shm_attach (key, upage);
+}
+
+/* Sleeps until woken by futex_wake() on UADDR, provided the
+   int at UADDR still equals VAL.  Returns 0 if woken, -1 if the
+   value differed, UADDR is misaligned, or nothing could wake
+   the caller. */
+static int
+sys_futex_wait (int *uaddr, int val)
+{
+  check_buffer (uaddr, sizeof *uaddr, false);
+  return futex_wait (uaddr, val);
+}
+
+/* Wakes up to CNT threads sleeping on UADDR.  Returns the number
+   woken, or -1 if UADDR is misaligned. */
+static int
+sys_futex_wake (int *uaddr, int cnt)
+{
+  check_buffer (uaddr, sizeof *uaddr, false);
+  return futex_wake (uaddr, cnt);
+}
+
+/* Creates a pipe and stores descriptors for its read and write
+   ends into UFDS[0] and UFDS[1].  Returns 0 if successful, -1 if
+   memory is short, the process has too many files open, or UFDS
+   cannot be written. */
+static int
+sys_pipe (int *ufds)
+{
+  struct fdtable *fds = thread_current ()->fds;
+  struct pipe *pipe;
+  int kfds[2];
+
+  check_buffer (ufds, sizeof kfds, true);
+  if (fds == NULL || (pipe = pipe_create ()) == NULL)
+    return -1;
+
+  kfds[0] = fdtable_insert_pipe (fds, pipe, false);
+  if (kfds[0] == -1)
+    {
+      pipe_close (pipe, false);
+      pipe_close (pipe, true);
+      return -1;
+    }
+  kfds[1] = fdtable_insert_pipe (fds, pipe, true);
+  if (kfds[1] == -1)
+    {
+      fdtable_close (fds, kfds[0]);
+      pipe_close (pipe, true);
+      return -1;
+    }
+
+  if (!copy_to_user (ufds, kfds, sizeof kfds))
+    {
+      fdtable_close (fds, kfds[0]);
+      fdtable_close (fds, kfds[1]);
+      return -1;
+    }
+  return 0;
+}
+
+/* Moves the position of FD to POSITION bytes from the start of
+   the file. */
+static void
+sys_seek (int fd, unsigned position)
+{
+  struct file *file = lookup_file (fd);
+  if (file != NULL)
+    file_seek (file, position);
+}
+
+/* Returns the position of FD in bytes from the start of the
+   file, or -1 if FD is not open. */
+static unsigned
+sys_tell (int fd)
+{
+  struct file *file = lookup_file (fd);
+  return file != NULL ? (unsigned) file_tell (file) : (unsigned) -1;
+}
+
+/* Closes FD.  Closing a descriptor that is not open does
+   nothing. */
+static void
+sys_close (int fd)
+{
+  struct fdtable *fds = thread_current ()->fds;
+  if (fds != NULL)
+    fdtable_close (fds, fd);
 }
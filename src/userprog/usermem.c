@@ -0,0 +1,182 @@
+#include "userprog/usermem.h"
+#include <debug.h>
+#include "threads/interrupt.h"
+#include "threads/vaddr.h"
+
+/* Exception table.
+
+   Each instruction below that may fault on a user address
+   records an entry in the .ex_table section naming the faulting
+   instruction and the address at which to resume if it does.
+   The linker script gathers the entries between _start_ex_table
+   and _end_ex_table. */
+struct ex_entry
+  {
+    uintptr_t insn;             /* Address of faulting instruction. */
+    uintptr_t fixup;            /* Where to resume after a fault. */
+  };
+
+extern const struct ex_entry _start_ex_table[], _end_ex_table[];
+
+/* Emits an exception table entry that resumes at FIXUP if the
+   instruction at label INSN faults. */
+#define EX_ENTRY(INSN, FIXUP)                           \
+        ".pushsection .ex_table, \"a\"\n"               \
+        ".long " #INSN ", " #FIXUP "\n"                 \
+        ".popsection\n"
+
+/* Returns true if the SIZE bytes starting at UADDR lie entirely
+   within user virtual memory. */
+static inline bool
+is_user_range (const void *uaddr, size_t size)
+{
+  uintptr_t start = (uintptr_t) uaddr;
+  return start + size >= start && start + size <= (uintptr_t) PHYS_BASE;
+}
+
+/* Called by the page fault handler for faults raised in kernel
+   mode.  If the faulting instruction has an exception table
+   entry, redirects F to resume at its fixup address and returns
+   true.  Otherwise, returns false. */
+bool
+usermem_fixup (struct intr_frame *f)
+{
+  const struct ex_entry *e;
+
+  for (e = _start_ex_table; e < _end_ex_table; e++)
+    if (e->insn == (uintptr_t) f->eip)
+      {
+        f->eip = (void (*) (void)) e->fixup;
+        return true;
+      }
+  return false;
+}
+
+/* Reads a byte at user virtual address USRC into *DST.
+   Returns true if successful, false if a segfault occurred. */
+bool
+get_user (uint8_t *dst, const uint8_t *usrc)
+{
+  int ok = 1;
+  uint8_t byte = 0;
+
+  if (!is_user_vaddr (usrc))
+    return false;
+  asm volatile ("1: movb %2, %1\n"
+                "   jmp 3f\n"
+                "2: movl $0, %0\n"
+                "3:\n"
+                EX_ENTRY (1b, 2b)
+                : "+r" (ok), "=q" (byte) : "m" (*usrc));
+  *dst = byte;
+  return ok;
+}
+
+/* Writes BYTE to user address UDST.
+   Returns true if successful, false if a segfault occurred. */
+bool
+put_user (uint8_t *udst, uint8_t byte)
+{
+  int ok = 1;
+
+  if (!is_user_vaddr (udst))
+    return false;
+  asm volatile ("1: movb %2, %1\n"
+                "   jmp 3f\n"
+                "2: movl $0, %0\n"
+                "3:\n"
+                EX_ENTRY (1b, 2b)
+                : "+r" (ok), "=m" (*udst) : "q" (byte));
+  return ok;
+}
+
+/* Copies SIZE bytes from SRC to DST a word at a time, then
+   copies any remaining bytes.  Either SRC or DST may be a user
+   address.  Returns true if successful, false if a segfault
+   occurred partway through. */
+static bool
+copy_checked (void *dst, const void *src, size_t size)
+{
+  int ok = 1;
+  size_t words = size / 4;
+  size_t bytes = size % 4;
+
+  asm volatile ("1: rep movsl\n"
+                "   movl %4, %%ecx\n"
+                "2: rep movsb\n"
+                "   jmp 4f\n"
+                "3: movl $0, %0\n"
+                "4:\n"
+                EX_ENTRY (1b, 3b)
+                EX_ENTRY (2b, 3b)
+                : "+r" (ok), "+D" (dst), "+S" (src), "+c" (words)
+                : "g" (bytes)
+                : "memory");
+  return ok;
+}
+
+/* Copies SIZE bytes from user address USRC to kernel address
+   DST.  Returns true if successful, false if USRC is not
+   entirely valid user memory. */
+bool
+copy_from_user (void *dst, const void *usrc, size_t size)
+{
+  return is_user_range (usrc, size) && copy_checked (dst, usrc, size);
+}
+
+/* Copies SIZE bytes from kernel address SRC to user address
+   UDST.  Returns true if successful, false if UDST is not
+   entirely valid, writable user memory. */
+bool
+copy_to_user (void *udst, const void *src, size_t size)
+{
+  return is_user_range (udst, size) && copy_checked (udst, src, size);
+}
+
+/* Copies a null-terminated string from user address USRC into
+   the SIZE-byte kernel buffer DST.  Returns the length of the
+   string, not including the null terminator.  If the string
+   does not fit in SIZE bytes, copies SIZE bytes without a null
+   terminator and returns SIZE.  Returns -1 if USRC is not valid
+   user memory. */
+int
+strncpy_from_user (char *dst, const char *usrc, size_t size)
+{
+  size_t i;
+
+  for (i = 0; i < size; i++)
+    {
+      if (!get_user ((uint8_t *) &dst[i], (const uint8_t *) usrc + i))
+        return -1;
+      if (dst[i] == '\0')
+        return i;
+    }
+  return size;
+}
+
+/* Checks that the SIZE bytes at UBUF are valid user memory,
+   writable as well if WRITE is true, by touching one byte in
+   each page.  Pages below the stack pointer are faulted in as
+   the stack grows.  Returns true if the whole buffer may be
+   accessed directly, false otherwise.
+
+   This is only a check at a point in time: it is sound because
+   a process's mappings cannot shrink while it is in a system
+   call. */
+bool
+probe_user (const void *ubuf, size_t size, bool write)
+{
+  const uint8_t *p, *end;
+  uint8_t byte;
+
+  if (size == 0)
+    return true;
+  if (!is_user_range (ubuf, size))
+    return false;
+
+  end = (const uint8_t *) ubuf + size;
+  for (p = ubuf; p < end; p = (const uint8_t *) pg_round_down (p) + PGSIZE)
+    if (!get_user (&byte, p) || (write && !put_user ((uint8_t *) p, byte)))
+      return false;
+  return true;
+}
@@ -0,0 +1,28 @@
+#ifndef USERPROG_USERMEM_H
+#define USERPROG_USERMEM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Access to user memory from the kernel.
+
+   These functions touch user memory directly.  If an access
+   faults on an address the process has no business touching,
+   the page fault handler redirects execution to a recovery
+   point registered in the kernel's exception table (see
+   usermem_fixup()) and the function reports failure, instead
+   of the kernel panicking.  Valid memory is therefore accessed
+   at full speed, with no page table walks in software. */
+
+bool get_user (uint8_t *dst, const uint8_t *usrc);
+bool put_user (uint8_t *udst, uint8_t byte);
+bool copy_from_user (void *dst, const void *usrc, size_t size);
+bool copy_to_user (void *udst, const void *src, size_t size);
+int strncpy_from_user (char *dst, const char *usrc, size_t size);
+bool probe_user (const void *ubuf, size_t size, bool write);
+
+struct intr_frame;
+bool usermem_fixup (struct intr_frame *);
+
+#endif /* userprog/usermem.h */